@@ -0,0 +1,48 @@
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local std::uint64_t thread_allocation_count = 0;
+
+std::uint64_t benchmark::allocation_count()
+{
+	return thread_allocation_count;
+}
+
+void* operator new(const std::size_t size)
+{
+	thread_allocation_count++;
+
+	if (void* const allocation = std::malloc(size == 0 ? 1 : size))
+	{
+		return allocation;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](const std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* const allocation) noexcept
+{
+	std::free(allocation);
+}
+
+void operator delete[](void* const allocation) noexcept
+{
+	std::free(allocation);
+}
+
+void operator delete(void* const allocation, std::size_t) noexcept
+{
+	std::free(allocation);
+}
+
+void operator delete[](void* const allocation, std::size_t) noexcept
+{
+	std::free(allocation);
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+namespace benchmark
+{
+	// counts every global operator new made by the calling thread
+	std::uint64_t allocation_count();
+}
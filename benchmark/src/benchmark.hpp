@@ -0,0 +1,70 @@
+#pragma once
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class boost_ssl_context_t;
+
+namespace benchmark
+{
+	typedef std::pair<std::string, double> counter_t;
+
+	struct result_t
+	{
+		std::string name;
+		std::uint64_t iterations;
+		double seconds;
+		std::vector<counter_t> counters;
+	};
+
+	class timer_t
+	{
+	public:
+		timer_t()
+			:	start_(clock_t::now()) { }
+
+		[[nodiscard]] double elapsed_seconds() const
+		{
+			const std::chrono::duration<double> elapsed = clock_t::now() - start_;
+
+			return elapsed.count();
+		}
+
+	protected:
+		typedef std::chrono::steady_clock clock_t;
+
+		clock_t::time_point start_;
+	};
+
+	// logs the result and, once an output file has been opened, appends it to that as a json line
+	void report(const result_t& result);
+
+	// results are appended, so runs of different builds can be collected in one file and compared
+	void open_json_output(const std::string& path);
+
+	// summarises latency samples in nanoseconds as p50/p99/p999 counters in microseconds, sorting them in place
+	std::vector<counter_t> latency_percentiles(std::vector<std::uint64_t>& latencies);
+
+	typedef std::function<void(boost_ssl_context_t& server_ssl_context, boost_ssl_context_t& client_ssl_context)> ssl_configuration_t;
+
+	// connects, handshakes and closes over loopback with the loopback contexts after configure has been applied to them
+	result_t run_handshakes(const std::string& name, const ssl_configuration_t& configure);
+
+	void run_gather_write_benchmarks();
+	void run_framing_benchmarks();
+	void run_scaling_benchmarks();
+	void run_coroutine_benchmarks();
+	void run_handshake_benchmarks();
+	void run_cipher_benchmarks();
+	void run_kernel_tls_benchmarks();
+	void run_transport_benchmarks();
+	void run_session_pool_benchmarks();
+	void run_serialisation_benchmarks();
+	void run_round_trip_benchmarks();
+	void run_compression_benchmarks();
+}
@@ -0,0 +1,105 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <stdexcept>
+#include <thread>
+
+struct cipher_t
+{
+	std::string name;
+	ssl_context_t::protocol_version_t protocol_version;
+	std::string cipher;
+};
+
+// the loopback certificate is ecdsa, so the tls 1.2 suites are the ecdsa ones
+static const std::vector<cipher_t> ciphers = {
+	{ .name = "tls 1.3 aes-128-gcm", .protocol_version = ssl_context_t::protocol_version_t::tls_1_3, .cipher = "TLS_AES_128_GCM_SHA256" },
+	{ .name = "tls 1.3 aes-256-gcm", .protocol_version = ssl_context_t::protocol_version_t::tls_1_3, .cipher = "TLS_AES_256_GCM_SHA384" },
+	{ .name = "tls 1.3 chacha20-poly1305", .protocol_version = ssl_context_t::protocol_version_t::tls_1_3, .cipher = "TLS_CHACHA20_POLY1305_SHA256" },
+	{ .name = "tls 1.2 aes-128-gcm", .protocol_version = ssl_context_t::protocol_version_t::tls_1_2, .cipher = "ECDHE-ECDSA-AES128-GCM-SHA256" },
+	{ .name = "tls 1.2 chacha20-poly1305", .protocol_version = ssl_context_t::protocol_version_t::tls_1_2, .cipher = "ECDHE-ECDSA-CHACHA20-POLY1305" }
+};
+
+static void use_cipher(boost_ssl_context_t& ssl_context, const cipher_t& cipher)
+{
+	ssl_context.set_protocol_versions(cipher.protocol_version, cipher.protocol_version);
+
+	if (cipher.protocol_version == ssl_context_t::protocol_version_t::tls_1_3)
+	{
+		ssl_context.set_cipher_suites(cipher.cipher);
+	}
+	else
+	{
+		ssl_context.set_cipher_list(cipher.cipher);
+	}
+
+	// x25519 carries the key exchange, p-256 has to stay listed for tls 1.2 to accept the certificate's curve
+	ssl_context.set_groups("X25519:P-256");
+}
+
+static benchmark::result_t run_bulk_transfer(const cipher_t& cipher)
+{
+	constexpr std::uint64_t chunk_size = 64 * 1024;
+	constexpr std::uint64_t chunk_count = 4096;
+
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+	const auto server_ssl_context = loopback::make_server_ssl_context();
+	const auto client_ssl_context = loopback::make_client_ssl_context();
+
+	use_cipher(*server_ssl_context, cipher);
+	use_cipher(*client_ssl_context, cipher);
+
+	auto [client, server] = loopback::make_socket_pair(io_context, server_ssl_context, client_ssl_context);
+
+	std::thread drain_thread(
+		[&server]()
+		{
+			std::vector<std::uint8_t> chunk(chunk_size);
+
+			for (std::uint64_t i = 0; i < chunk_count; i++)
+			{
+				if (!server->read(chunk.data(), chunk.size()))
+				{
+					break;
+				}
+			}
+		}
+	);
+
+	const std::vector<std::uint8_t> chunk(chunk_size, 0x5A);
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < chunk_count; i++)
+	{
+		if (!client->write(chunk.data(), chunk.size()))
+		{
+			break;
+		}
+	}
+
+	drain_thread.join();
+
+	const double seconds = timer.elapsed_seconds();
+	const double mebibytes = static_cast<double>(chunk_size * chunk_count) / (1024.0 * 1024.0);
+
+	return { .name = cipher.name + " bulk transfer", .iterations = chunk_count, .seconds = seconds, .counters = { { "MiB/s", mebibytes / seconds } } };
+}
+
+void benchmark::run_cipher_benchmarks()
+{
+	for (const cipher_t& cipher : ciphers)
+	{
+		report(run_handshakes(cipher.name + " full handshake",
+			[&cipher](boost_ssl_context_t& server_ssl_context, boost_ssl_context_t& client_ssl_context)
+			{
+				server_ssl_context.disable_session_resumption();
+
+				use_cipher(server_ssl_context, cipher);
+				use_cipher(client_ssl_context, cipher);
+			}
+		));
+
+		report(run_bulk_transfer(cipher));
+	}
+}
@@ -0,0 +1,177 @@
+#include "benchmark.hpp"
+
+#include <request/request.hpp>
+#include <response/response.hpp>
+#include <compression/compression.hpp>
+#include <endian/endian.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+// a wan link slow enough that the bytes saved can outweigh the time spent compressing them
+static constexpr double link_bits_per_second = 100e6;
+
+struct codec_configuration_t
+{
+	const char* name;
+	compression::options_t options;
+};
+
+static constexpr codec_configuration_t configurations[] = {
+	{ .name = "lz4", .options = { .codec = compression::codec_t::lz4, .level = 1, .min_size = 0 } },
+	{ .name = "lz4 hc 9", .options = { .codec = compression::codec_t::lz4, .level = 9, .min_size = 0 } },
+	{ .name = "zstd 1", .options = { .codec = compression::codec_t::zstd, .level = 1, .min_size = 0 } },
+	{ .name = "zstd 3", .options = { .codec = compression::codec_t::zstd, .level = 3, .min_size = 0 } },
+	{ .name = "zstd 9", .options = { .codec = compression::codec_t::zstd, .level = 9, .min_size = 0 } },
+	{ .name = "zstd 19", .options = { .codec = compression::codec_t::zstd, .level = 19, .min_size = 0 } },
+	{ .name = "zstd dictionary 3", .options = { .codec = compression::codec_t::zstd_dictionary, .level = 3, .min_size = 0 } }
+};
+
+static std::vector<std::uint8_t> frame_body(const serialisation::frame_t& frame)
+{
+	request::request_buffer_size_t little_endian_header_size = 0;
+
+	std::memcpy(&little_endian_header_size, frame.data(), sizeof(little_endian_header_size));
+
+	const std::uint64_t body_offset = sizeof(little_endian_header_size) + endian::from_little(little_endian_header_size);
+
+	return { frame.data() + body_offset, frame.data() + frame.size() };
+}
+
+// records in the style of a real api's payloads, repetitive in structure but not in values
+static std::vector<std::uint8_t> make_record_payload(std::mt19937_64& random, const std::uint64_t size)
+{
+	static constexpr const char* regions[] = { "eu-west-1", "eu-central-1", "us-east-1", "us-west-2", "ap-southeast-1" };
+	static constexpr const char* tiers[] = { "free", "standard", "gold" };
+
+	std::string payload;
+
+	while (payload.size() < size)
+	{
+		payload += fmt::format(R"({{"user_id":{},"name":"user_{}","region":"{}","tier":"{}","balance":{},"active":{}}})",
+			random() % 1000000, random() % 100000, regions[random() % std::size(regions)], tiers[random() % std::size(tiers)], random() % 100000, random() % 2 == 0);
+	}
+
+	payload.resize(size);
+
+	return { payload.begin(), payload.end() };
+}
+
+static std::vector<std::uint8_t> make_test_request_body(std::mt19937_64& random, const std::uint64_t payload_size)
+{
+	const request::request_t request = request::construct::make_test_request(random(), random(), make_record_payload(random, payload_size));
+
+	return frame_body(request.frame);
+}
+
+static std::vector<std::uint8_t> make_stats_response_body(std::mt19937_64& random)
+{
+	metrics::snapshot_t snapshot = { };
+
+	snapshot.accepted_connections = random() % 10000;
+	snapshot.bytes_in = random();
+	snapshot.bytes_out = random();
+
+	// latencies cluster in a band of buckets, as they do under a steady load
+	for (metrics::request_type_snapshot_t& request_type : snapshot.request_types)
+	{
+		for (std::uint64_t i = 40; i < 80; i++)
+		{
+			request_type.handler_latency_ns.counts[i] = random() % 1000;
+			request_type.end_to_end_latency_ns.counts[i + 8] = random() % 1000;
+			request_type.count += request_type.handler_latency_ns.counts[i];
+		}
+	}
+
+	return frame_body(response::construct::make_stats_response(random(), snapshot));
+}
+
+static benchmark::result_t run_codec(const std::string& body_name, const std::vector<std::uint8_t>& body, const codec_configuration_t& configuration)
+{
+	constexpr std::uint64_t byte_budget = 64 * 1024 * 1024;
+
+	const std::uint64_t count = std::max<std::uint64_t>(byte_budget / body.size(), 100);
+
+	std::vector<std::uint8_t> compressed;
+	std::vector<std::uint8_t> decompressed;
+
+	const benchmark::timer_t compress_timer;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		// the codec could not shrink this body, so it would be sent as it is
+		if (!compression::compress(configuration.options, body, compressed))
+		{
+			return { .name = fmt::format("compress {} with {}", body_name, configuration.name), .iterations = 0, .seconds = 0.0, .counters = { { "compression ratio", 1.0 } } };
+		}
+	}
+
+	const double compress_seconds = compress_timer.elapsed_seconds();
+
+	const benchmark::timer_t decompress_timer;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		if (!compression::decompress(configuration.options.codec, compressed, body.size(), decompressed))
+		{
+			throw std::runtime_error("compression benchmark body failed to decompress");
+		}
+	}
+
+	const double decompress_seconds = decompress_timer.elapsed_seconds();
+
+	if (decompressed != body)
+	{
+		throw std::runtime_error("compression benchmark body did not survive a round trip");
+	}
+
+	const double megabytes = static_cast<double>(count * body.size()) / 1e6;
+
+	// the time one body takes to compress, cross the link and decompress, against sending it as it is
+	const double codec_microseconds = (compress_seconds + decompress_seconds) * 1e6 / count;
+	const double link_microseconds = static_cast<double>(compressed.size()) * 8.0 / link_bits_per_second * 1e6;
+	const double uncompressed_link_microseconds = static_cast<double>(body.size()) * 8.0 / link_bits_per_second * 1e6;
+
+	return { .name = fmt::format("compress {} with {}", body_name, configuration.name), .iterations = count, .seconds = compress_seconds + decompress_seconds, .counters = {
+		{ "compression ratio", static_cast<double>(body.size()) / compressed.size() },
+		{ "compress MB/s", megabytes / compress_seconds },
+		{ "decompress MB/s", megabytes / decompress_seconds },
+		{ "us per body over 100 Mbit/s", codec_microseconds + link_microseconds },
+		{ "us uncompressed over 100 Mbit/s", uncompressed_link_microseconds }
+	} };
+}
+
+void benchmark::run_compression_benchmarks()
+{
+	std::mt19937_64 random(1);
+
+	// trained on bodies other than the ones measured, as a dictionary shipped ahead of time would be
+	std::vector<std::vector<std::uint8_t>> samples;
+
+	for (std::uint64_t i = 0; i < 1000; i++)
+	{
+		samples.push_back(i % 2 == 0 ? make_test_request_body(random, 512) : make_stats_response_body(random));
+	}
+
+	if (!compression::load_dictionary(compression::train_dictionary(samples, 16 * 1024), 3))
+	{
+		throw std::runtime_error("compression benchmark failed to train a dictionary");
+	}
+
+	const std::pair<std::string, std::vector<std::uint8_t>> bodies[] = {
+		{ "512 byte test request", make_test_request_body(random, 512) },
+		{ "16 KiB test request", make_test_request_body(random, 16 * 1024) },
+		{ "stats response", make_stats_response_body(random) }
+	};
+
+	for (const auto& [body_name, body] : bodies)
+	{
+		for (const codec_configuration_t& configuration : configurations)
+		{
+			report(run_codec(fmt::format("{} ({} bytes)", body_name, body.size()), body, configuration));
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#include "benchmark.hpp"
+#include "allocation_counter.hpp"
+#include "loopback/loopback.hpp"
+
+#include <thread>
+
+static constexpr std::uint64_t read_count = 200000;
+static constexpr std::uint64_t frame_size = 64;
+
+static void read_with_callbacks(socket_t& socket, std::vector<std::uint8_t>& frame, const std::uint64_t remaining)
+{
+	socket.async_read(frame.data(), frame.size(),
+		[&socket, &frame, remaining](const std::uint8_t is_valid)
+		{
+			if (is_valid && remaining > 1)
+			{
+				read_with_callbacks(socket, frame, remaining - 1);
+			}
+		}
+	);
+}
+
+static awaitable_t<void> read_with_coroutine(socket_t& socket, std::vector<std::uint8_t>& frame)
+{
+	for (std::uint64_t i = 0; i < read_count; i++)
+	{
+		if (!co_await socket.co_read(frame.data(), frame.size()))
+		{
+			co_return;
+		}
+	}
+}
+
+// the client writes from another thread while the io_context runs the server reads on this one,
+// so the allocation counter only sees the read path
+template <class start_reads_t>
+static benchmark::result_t run_reads(const std::string& name, const start_reads_t& start_reads)
+{
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+
+	auto [client, server] = loopback::make_socket_pair(io_context, loopback::make_server_ssl_context(), loopback::make_client_ssl_context());
+
+	std::vector<std::uint8_t> frame(frame_size);
+
+	std::thread write_thread(
+		[&client]()
+		{
+			const std::vector<std::uint8_t> frame(frame_size);
+
+			for (std::uint64_t i = 0; i < read_count; i++)
+			{
+				if (!client->write(frame.data(), frame.size()))
+				{
+					break;
+				}
+			}
+		}
+	);
+
+	const std::uint64_t allocations_before = benchmark::allocation_count();
+	const benchmark::timer_t timer;
+
+	start_reads(*server, frame);
+
+	io_context->run();
+
+	const double seconds = timer.elapsed_seconds();
+	const double allocations_per_read = static_cast<double>(benchmark::allocation_count() - allocations_before) / read_count;
+
+	write_thread.join();
+
+	client->close();
+	server->close();
+
+	return { .name = name, .iterations = read_count, .seconds = seconds, .counters = { { "allocations per read", allocations_per_read } } };
+}
+
+void benchmark::run_coroutine_benchmarks()
+{
+	report(run_reads("callback reads",
+		[](socket_t& socket, std::vector<std::uint8_t>& frame)
+		{
+			read_with_callbacks(socket, frame, read_count);
+		}
+	));
+
+	report(run_reads("coroutine reads",
+		[](socket_t& socket, std::vector<std::uint8_t>& frame)
+		{
+			boost::asio::co_spawn(socket.executor(), read_with_coroutine(socket, frame), boost::asio::detached);
+		}
+	));
+}
@@ -0,0 +1,73 @@
+#include "benchmark.hpp"
+#include "allocation_counter.hpp"
+
+#include <request/request.hpp>
+#include <response/response.hpp>
+#include <schema/schema.hpp>
+#include <schema/request_generated.h>
+#include <schema/response_generated.h>
+
+// the framing path before frames were built in a single builder, kept as the baseline
+static std::vector<std::uint8_t> make_copied_test_request(const std::uint64_t key)
+{
+	std::vector<std::uint8_t> request_buffer = serialisation::serialise(CREATION_WRAPPER(Client::CreateTestRequest), key);
+
+	const std::vector<std::uint8_t> request_header = request::construct::make_request_header(Client::RequestId_Test, 1, request_buffer.size());
+
+	request_buffer.insert(request_buffer.begin(), request_header.begin(), request_header.end());
+
+	const request::request_buffer_size_t header_size = request_header.size();
+	const auto header_size_begin = reinterpret_cast<const std::uint8_t*>(&header_size);
+
+	request_buffer.insert(request_buffer.begin(), header_size_begin, header_size_begin + sizeof(header_size));
+
+	return request_buffer;
+}
+
+static std::vector<std::uint8_t> make_copied_test_response(const std::uint64_t key)
+{
+	std::vector<std::uint8_t> response_buffer = serialisation::serialise(CREATION_WRAPPER(Client::CreateTestResponse), key);
+
+	const std::vector<std::uint8_t> response_header = response::construct::make_response_header(1, response_buffer.size());
+
+	response_buffer.insert(response_buffer.begin(), response_header.begin(), response_header.end());
+
+	const request::request_buffer_size_t header_size = response_header.size();
+	const auto header_size_begin = reinterpret_cast<const std::uint8_t*>(&header_size);
+
+	response_buffer.insert(response_buffer.begin(), header_size_begin, header_size_begin + sizeof(header_size));
+
+	return response_buffer;
+}
+
+template <class make_function_t>
+static benchmark::result_t run_framing(const std::string& name, const make_function_t& make_function)
+{
+	constexpr std::uint64_t frame_count = 1000000;
+
+	std::uint64_t bytes = 0;
+
+	const std::uint64_t allocations_before = benchmark::allocation_count();
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < frame_count; i++)
+	{
+		const auto frame = make_function(i);
+
+		bytes += frame.size();
+	}
+
+	const double seconds = timer.elapsed_seconds();
+	const double allocations_per_frame = static_cast<double>(benchmark::allocation_count() - allocations_before) / frame_count;
+
+	return { .name = name, .iterations = frame_count, .seconds = seconds, .counters = { { "allocations per frame", allocations_per_frame }, { "bytes per frame", static_cast<double>(bytes) / frame_count } } };
+}
+
+void benchmark::run_framing_benchmarks()
+{
+	report(run_framing("copied request frame", make_copied_test_request));
+	report(run_framing("request frame", [](const std::uint64_t key) { return request::construct::make_test_request(1, key).frame; }));
+
+	report(run_framing("copied response frame", make_copied_test_response));
+	report(run_framing("response frame", [](const std::uint64_t key) { return response::construct::make_test_response(1, key); }));
+}
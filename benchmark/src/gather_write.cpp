@@ -0,0 +1,97 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <request/request.hpp>
+
+#include <openssl/ssl.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+static std::atomic<std::uint64_t> records_written = 0;
+
+// every record the client writes is flushed by its own send, so this also counts send calls
+static void count_records(const int write_p, int, const int content_type, const void*, std::size_t, SSL*, void*)
+{
+	if (write_p && content_type == SSL3_RT_HEADER)
+	{
+		records_written.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+static constexpr std::uint64_t size_prefix_size = sizeof(request::request_buffer_size_t);
+
+static void send_split_buffer(socket_t& socket, const request::request_t& request)
+{
+	socket.write(request.frame.data(), size_prefix_size);
+
+	socket.write(request.frame.data() + size_prefix_size, request.frame.size() - size_prefix_size);
+}
+
+static void send_gathered_buffer(socket_t& socket, const request::request_t& request)
+{
+	const std::array<socket_buffer_t, 2> frame = {{
+		{ .data = request.frame.data(), .size = size_prefix_size },
+		{ .data = request.frame.data() + size_prefix_size, .size = request.frame.size() - size_prefix_size }
+	}};
+
+	socket.gather_write(frame);
+}
+
+template <class send_function_t>
+static benchmark::result_t run_loopback_writes(const std::string& name, const send_function_t& send_function)
+{
+	constexpr std::uint64_t request_count = 100000;
+
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+	const auto server_ssl_context = loopback::make_server_ssl_context();
+	const auto client_ssl_context = loopback::make_client_ssl_context();
+
+	SSL_CTX_set_msg_callback(client_ssl_context->native_handle().native_handle(), count_records);
+
+	auto [client, server] = loopback::make_socket_pair(io_context, server_ssl_context, client_ssl_context);
+
+	const request::request_t request = request::construct::make_test_request(1, 0x12345);
+	const std::uint64_t frame_size = request.frame.size();
+
+	std::thread drain_thread(
+		[&server, frame_size]()
+		{
+			std::vector<std::uint8_t> frame(frame_size);
+
+			for (std::uint64_t i = 0; i < request_count; i++)
+			{
+				if (!server->read(frame.data(), frame.size()))
+				{
+					break;
+				}
+			}
+		}
+	);
+
+	records_written = 0;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < request_count; i++)
+	{
+		send_function(*client, request);
+	}
+
+	drain_thread.join();
+
+	const double seconds = timer.elapsed_seconds();
+	const double records_per_request = static_cast<double>(records_written.load()) / request_count;
+
+	client->close();
+	server->close();
+
+	return { .name = name, .iterations = request_count, .seconds = seconds, .counters = { { "tls records (sends) per request", records_per_request } } };
+}
+
+void benchmark::run_gather_write_benchmarks()
+{
+	report(run_loopback_writes("split write", send_split_buffer));
+	report(run_loopback_writes("gather write", send_gathered_buffer));
+}
@@ -0,0 +1,104 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <stdexcept>
+#include <thread>
+
+// every connection is opened, handshaken and closed again, the way a reconnecting client would
+benchmark::result_t benchmark::run_handshakes(const std::string& name, const ssl_configuration_t& configure)
+{
+	typedef boost::asio::ip::tcp tcp_t;
+
+	constexpr std::uint64_t handshake_count = 2000;
+
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+	const auto server_ssl_context = loopback::make_server_ssl_context();
+	const auto client_ssl_context = loopback::make_client_ssl_context();
+
+	configure(*server_ssl_context, *client_ssl_context);
+
+	tcp_t::acceptor acceptor(*io_context, tcp_t::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+	const std::uint16_t port = acceptor.local_endpoint().port();
+
+	std::thread server_thread(
+		[&acceptor, &io_context, &server_ssl_context]()
+		{
+			for (std::uint64_t i = 0; i < handshake_count; i++)
+			{
+				boost_tcp_socket_t server(io_context, acceptor.accept(), server_ssl_context);
+
+				// the byte also carries any tls 1.3 ticket to the client before the connection closes
+				constexpr std::uint8_t ready = 1;
+
+				if (!server.handshake(socket_t::handshake_type_t::server) || !server.write(&ready, sizeof(ready)))
+				{
+					break;
+				}
+
+				server.close();
+			}
+		}
+	);
+
+	std::uint64_t resumed_count = 0;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < handshake_count; i++)
+	{
+		boost_tcp_socket_t client(io_context, client_ssl_context);
+
+		std::uint8_t ready = 0;
+
+		if (!client.connect(boost::asio::ip::address_v4::loopback().to_uint(), port) || !client.handshake(socket_t::handshake_type_t::client) || !client.read(&ready, sizeof(ready)))
+		{
+			server_thread.join();
+
+			throw std::runtime_error("handshake benchmark client failed to connect");
+		}
+
+		resumed_count += client.is_session_resumed();
+
+		client.close();
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	server_thread.join();
+
+	return { .name = name, .iterations = handshake_count, .seconds = seconds, .counters = {
+		{ "milliseconds per handshake", seconds * 1000.0 / handshake_count },
+		{ "resumed fraction", static_cast<double>(resumed_count) / handshake_count }
+	} };
+}
+
+void benchmark::run_handshake_benchmarks()
+{
+	report(run_handshakes("full handshake",
+		[](boost_ssl_context_t& server_ssl_context, boost_ssl_context_t&)
+		{
+			server_ssl_context.disable_session_resumption();
+		}
+	));
+
+	report(run_handshakes("resumed handshake (session cache)",
+		[](boost_ssl_context_t& server_ssl_context, boost_ssl_context_t& client_ssl_context)
+		{
+			// clears the tickets, which the cache then serves without
+			server_ssl_context.disable_session_resumption();
+			server_ssl_context.enable_session_cache(1024, std::chrono::minutes(10));
+
+			client_ssl_context.enable_session_reuse();
+		}
+	));
+
+	report(run_handshakes("resumed handshake (session tickets)",
+		[](boost_ssl_context_t& server_ssl_context, boost_ssl_context_t& client_ssl_context)
+		{
+			server_ssl_context.enable_session_tickets(std::chrono::hours(1));
+
+			client_ssl_context.enable_session_reuse();
+		}
+	));
+}
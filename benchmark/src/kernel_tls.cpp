@@ -0,0 +1,106 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <cstdio>
+#include <thread>
+
+static constexpr std::uint64_t chunk_size = 64 * 1024;
+static constexpr std::uint64_t chunk_count = 4096;
+
+static std::vector<benchmark::counter_t> offload_counters(const boost_tcp_socket_t& socket)
+{
+	const boost_tcp_socket_t::tls_offload_t offload = socket.tls_offload();
+
+	const std::uint8_t is_send_offloaded = offload == boost_tcp_socket_t::tls_offload_t::send || offload == boost_tcp_socket_t::tls_offload_t::send_and_receive;
+	const std::uint8_t is_receive_offloaded = offload == boost_tcp_socket_t::tls_offload_t::receive || offload == boost_tcp_socket_t::tls_offload_t::send_and_receive;
+
+	return { { "send offloaded", is_send_offloaded }, { "receive offloaded", is_receive_offloaded } };
+}
+
+template <class send_function_t>
+static benchmark::result_t run_transfer(const std::string& name, const std::uint8_t kernel_tls, const send_function_t& send_function)
+{
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+
+	auto [client, server] = loopback::make_socket_pair(io_context, loopback::make_server_ssl_context(), loopback::make_client_ssl_context(), kernel_tls);
+
+	std::thread drain_thread(
+		[&client]()
+		{
+			std::vector<std::uint8_t> chunk(chunk_size);
+
+			for (std::uint64_t i = 0; i < chunk_count; i++)
+			{
+				if (!client->read(chunk.data(), chunk.size()))
+				{
+					break;
+				}
+			}
+		}
+	);
+
+	const benchmark::timer_t timer;
+
+	send_function(*server);
+
+	drain_thread.join();
+
+	const double seconds = timer.elapsed_seconds();
+	const double mebibytes = static_cast<double>(chunk_size * chunk_count) / (1024.0 * 1024.0);
+
+	std::vector<benchmark::counter_t> counters = offload_counters(*server);
+
+	counters.emplace_back("MiB/s", mebibytes / seconds);
+
+	return { .name = name, .iterations = chunk_count, .seconds = seconds, .counters = std::move(counters) };
+}
+
+static void write_chunks(boost_tcp_socket_t& socket)
+{
+	const std::vector<std::uint8_t> chunk(chunk_size, 0x5A);
+
+	for (std::uint64_t i = 0; i < chunk_count; i++)
+	{
+		if (!socket.write(chunk.data(), chunk.size()))
+		{
+			break;
+		}
+	}
+}
+
+void benchmark::run_kernel_tls_benchmarks()
+{
+	report(run_transfer("asio stream bulk transfer", 0, write_chunks));
+	report(run_transfer("kernel tls mode bulk transfer", 1, write_chunks));
+
+#ifndef _WIN32
+	// a file the size of the transfer, served the way a large response body would be
+	FILE* const file = std::tmpfile();
+
+	if (file == nullptr)
+	{
+		spdlog::error("failed to create the send file benchmark's file");
+
+		return;
+	}
+
+	const std::vector<std::uint8_t> chunk(chunk_size, 0x5A);
+
+	for (std::uint64_t i = 0; i < chunk_count; i++)
+	{
+		std::fwrite(chunk.data(), 1, chunk.size(), file);
+	}
+
+	std::fflush(file);
+
+	const auto send_file = [file](boost_tcp_socket_t& socket)
+	{
+		(void)socket.send_file(fileno(file), 0, chunk_size * chunk_count);
+	};
+
+	report(run_transfer("asio stream send file", 0, send_file));
+	report(run_transfer("kernel tls mode send file", 1, send_file));
+
+	std::fclose(file);
+#endif
+}
@@ -0,0 +1,243 @@
+#include "loopback.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <filesystem>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+struct self_signed_identity_t
+{
+	std::string certificate;
+	std::string private_key;
+};
+
+static std::string bio_to_string(BIO* const bio)
+{
+	char* data = nullptr;
+
+	const long size = BIO_get_mem_data(bio, &data);
+
+	return { data, static_cast<std::size_t>(size) };
+}
+
+static self_signed_identity_t make_self_signed_identity()
+{
+	EVP_PKEY* const key = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256");
+	X509* const certificate = X509_new();
+
+	if (key == nullptr || certificate == nullptr)
+	{
+		throw std::runtime_error("failed to allocate self signed identity");
+	}
+
+	ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+	X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+	X509_gmtime_adj(X509_getm_notAfter(certificate), 60 * 60 * 24);
+	X509_set_pubkey(certificate, key);
+
+	X509_NAME* const name = X509_get_subject_name(certificate);
+
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("loopback"), -1, -1, 0);
+	X509_set_issuer_name(certificate, name);
+	X509_sign(certificate, key, EVP_sha256());
+
+	BIO* const certificate_bio = BIO_new(BIO_s_mem());
+	BIO* const key_bio = BIO_new(BIO_s_mem());
+
+	PEM_write_bio_X509(certificate_bio, certificate);
+	PEM_write_bio_PrivateKey(key_bio, key, nullptr, nullptr, 0, nullptr, nullptr);
+
+	self_signed_identity_t identity = { .certificate = bio_to_string(certificate_bio), .private_key = bio_to_string(key_bio) };
+
+	BIO_free(key_bio);
+	BIO_free(certificate_bio);
+	X509_free(certificate);
+	EVP_PKEY_free(key);
+
+	return identity;
+}
+
+static std::span<std::uint8_t> as_span(std::string& buffer)
+{
+	return { reinterpret_cast<std::uint8_t*>(buffer.data()), buffer.size() };
+}
+
+std::shared_ptr<boost_ssl_context_t> loopback::make_server_ssl_context()
+{
+	static self_signed_identity_t identity = make_self_signed_identity();
+
+	auto ssl_context = std::make_shared<boost_ssl_context_t>(boost_ssl_context_t::ssl_method_t::tls_server);
+
+	ssl_context->disable_peer_verification();
+	ssl_context->use_certificate(as_span(identity.certificate), ssl_context_t::crypto_file_format_t::pem);
+	ssl_context->use_private_key(as_span(identity.private_key), ssl_context_t::crypto_file_format_t::pem);
+
+	return ssl_context;
+}
+
+std::shared_ptr<boost_ssl_context_t> loopback::make_client_ssl_context()
+{
+	auto ssl_context = std::make_shared<boost_ssl_context_t>(boost_ssl_context_t::ssl_method_t::tls_client);
+
+	ssl_context->disable_peer_verification();
+
+	return ssl_context;
+}
+
+std::uint16_t loopback::find_free_port()
+{
+	typedef boost::asio::ip::tcp tcp_t;
+
+	boost::asio::io_context io_context;
+
+	const tcp_t::acceptor acceptor(io_context, tcp_t::endpoint(tcp_t::v4(), 0));
+
+	return acceptor.local_endpoint().port();
+}
+
+std::unique_ptr<boost_tcp_socket_t> loopback::connect_client(const std::shared_ptr<boost::asio::io_context>& io_context, const std::shared_ptr<boost_ssl_context_t>& ssl_context, const std::uint16_t port)
+{
+	// a runtime binds its listeners on another thread, so the first attempts may be refused
+	for (std::uint32_t attempt = 0; attempt < 100; attempt++)
+	{
+		auto socket = std::make_unique<boost_tcp_socket_t>(io_context, ssl_context);
+
+		if (socket->connect(boost::asio::ip::address_v4::loopback().to_uint(), port))
+		{
+			if (!socket->handshake(socket_t::handshake_type_t::client))
+			{
+				throw std::runtime_error("loopback client failed to handshake");
+			}
+
+			return socket;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	throw std::runtime_error("loopback client failed to connect");
+}
+
+loopback::socket_pair_t loopback::make_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context, const std::shared_ptr<boost_ssl_context_t>& server_ssl_context, const std::shared_ptr<boost_ssl_context_t>& client_ssl_context, const std::uint8_t kernel_tls)
+{
+	typedef boost::asio::ip::tcp tcp_t;
+
+	tcp_t::acceptor acceptor(*io_context, tcp_t::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+	const std::uint16_t port = acceptor.local_endpoint().port();
+
+	auto server_future = std::async(std::launch::async,
+		[&acceptor, &io_context, &server_ssl_context, kernel_tls]()
+		{
+			auto server = std::make_unique<boost_tcp_socket_t>(io_context, acceptor.accept(), server_ssl_context);
+
+			if (kernel_tls)
+			{
+				server->enable_kernel_tls();
+			}
+
+			if (!server->handshake(socket_t::handshake_type_t::server))
+			{
+				throw std::runtime_error("loopback server failed to handshake");
+			}
+
+			return server;
+		}
+	);
+
+	auto client = std::make_unique<boost_tcp_socket_t>(io_context, client_ssl_context);
+
+	if (kernel_tls)
+	{
+		client->enable_kernel_tls();
+	}
+
+	if (!client->connect(boost::asio::ip::address_v4::loopback().to_uint(), port) || !client->handshake(socket_t::handshake_type_t::client))
+	{
+		throw std::runtime_error("loopback client failed to connect");
+	}
+
+	return { .client = std::move(client), .server = server_future.get() };
+}
+
+loopback::transport_pair_t loopback::make_plain_tcp_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context)
+{
+	typedef boost::asio::ip::tcp tcp_t;
+
+	tcp_t::acceptor acceptor(*io_context, tcp_t::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+	auto client = std::make_unique<boost_plain_tcp_socket_t>(io_context);
+
+	if (!client->connect(acceptor.local_endpoint()))
+	{
+		throw std::runtime_error("loopback plaintext client failed to connect");
+	}
+
+	return { .client = std::move(client), .server = std::make_unique<boost_plain_tcp_socket_t>(io_context, acceptor.accept()) };
+}
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+loopback::transport_pair_t loopback::make_unix_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context)
+{
+	typedef boost::asio::local::stream_protocol local_t;
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "socketsl_loopback.sock";
+
+	std::filesystem::remove(path);
+
+	local_t::acceptor acceptor(*io_context, local_t::endpoint(path.string()));
+
+	auto client = std::make_unique<boost_unix_socket_t>(io_context);
+
+	if (!client->connect(acceptor.local_endpoint()))
+	{
+		throw std::runtime_error("loopback unix domain client failed to connect");
+	}
+
+	auto server = std::make_unique<boost_unix_socket_t>(io_context, acceptor.accept());
+
+	std::filesystem::remove(path);
+
+	return { .client = std::move(client), .server = std::move(server) };
+}
+#endif
+
+#ifdef __linux__
+loopback::transport_pair_t loopback::make_shm_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context, const std::chrono::nanoseconds busy_poll)
+{
+	typedef boost::asio::local::stream_protocol local_t;
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "socketsl_loopback_shm.sock";
+
+	std::filesystem::remove(path);
+
+	local_t::acceptor acceptor(*io_context, local_t::endpoint(path.string()));
+
+	auto client = std::make_unique<boost_shm_socket_t>(io_context);
+
+	if (!client->connect(path.string(), ""))
+	{
+		throw std::runtime_error("loopback shared memory client failed to connect");
+	}
+
+	auto server = std::make_unique<boost_shm_socket_t>(io_context, acceptor.accept());
+
+	std::filesystem::remove(path);
+
+	server->set_busy_poll(busy_poll);
+	client->set_busy_poll(busy_poll);
+
+	// the server only sends the segment, so both handshakes can run on this thread
+	if (!server->handshake(socket_t::handshake_type_t::server) || !client->handshake(socket_t::handshake_type_t::client))
+	{
+		throw std::runtime_error("loopback shared memory pair failed to handshake");
+	}
+
+	return { .client = std::move(client), .server = std::move(server) };
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#include <network/plain_socket.hpp>
+#include <network/shm_socket.hpp>
+
+#include <memory>
+
+namespace loopback
+{
+	struct socket_pair_t
+	{
+		std::unique_ptr<boost_tcp_socket_t> client;
+		std::unique_ptr<boost_tcp_socket_t> server;
+	};
+
+	// either end may be any transport, for benchmarks which compare them
+	struct transport_pair_t
+	{
+		std::unique_ptr<socket_t> client;
+		std::unique_ptr<socket_t> server;
+	};
+
+	// self signed certificate held in memory, so the benchmarks need no key files
+	std::shared_ptr<boost_ssl_context_t> make_server_ssl_context();
+	std::shared_ptr<boost_ssl_context_t> make_client_ssl_context();
+
+	// the port is released before returning, so it is only very likely to still be free
+	std::uint16_t find_free_port();
+
+	// connects and handshakes a client to a server listening on 127.0.0.1, retrying while the server is still binding
+	std::unique_ptr<boost_tcp_socket_t> connect_client(const std::shared_ptr<boost::asio::io_context>& io_context, const std::shared_ptr<boost_ssl_context_t>& ssl_context, std::uint16_t port);
+
+	// connects and handshakes a client/server pair over 127.0.0.1, optionally with both ends in kernel tls mode
+	socket_pair_t make_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context, const std::shared_ptr<boost_ssl_context_t>& server_ssl_context, const std::shared_ptr<boost_ssl_context_t>& client_ssl_context, std::uint8_t kernel_tls = 0);
+
+	// connects a plaintext client/server pair over 127.0.0.1
+	transport_pair_t make_plain_tcp_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context);
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	// connects a client/server pair over a unix domain socket in the temporary directory, the socket file is removed once they are connected
+	transport_pair_t make_unix_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context);
+#endif
+
+#ifdef __linux__
+	// connects and handshakes a shared memory client/server pair, both ends spin for up to busy_poll before sleeping
+	transport_pair_t make_shm_socket_pair(const std::shared_ptr<boost::asio::io_context>& io_context, std::chrono::nanoseconds busy_poll = std::chrono::nanoseconds(0));
+#endif
+}
@@ -0,0 +1,45 @@
+#include "benchmark.hpp"
+
+#include <string_view>
+
+// benchmark [--json <path>]
+std::int32_t main(const std::int32_t argument_count, const char* const* const arguments)
+{
+	try
+	{
+		for (std::int32_t i = 1; i < argument_count; i++)
+		{
+			if (std::string_view(arguments[i]) == "--json" && i + 1 < argument_count)
+			{
+				benchmark::open_json_output(arguments[++i]);
+			}
+			else
+			{
+				spdlog::error("unknown argument {}", arguments[i]);
+
+				return 1;
+			}
+		}
+
+		spdlog::info("benchmark");
+
+		benchmark::run_serialisation_benchmarks();
+		benchmark::run_compression_benchmarks();
+		benchmark::run_framing_benchmarks();
+		benchmark::run_gather_write_benchmarks();
+		benchmark::run_coroutine_benchmarks();
+		benchmark::run_handshake_benchmarks();
+		benchmark::run_cipher_benchmarks();
+		benchmark::run_kernel_tls_benchmarks();
+		benchmark::run_transport_benchmarks();
+		benchmark::run_session_pool_benchmarks();
+		benchmark::run_round_trip_benchmarks();
+		benchmark::run_scaling_benchmarks();
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(e.what());
+	}
+
+	return 0;
+}
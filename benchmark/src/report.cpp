@@ -0,0 +1,93 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+static std::mutex output_mutex;
+static std::ofstream json_output;
+
+static std::string escape_json(const std::string_view& text)
+{
+	std::string escaped;
+
+	escaped.reserve(text.size());
+
+	for (const char character : text)
+	{
+		if (character == '"' || character == '\\')
+		{
+			escaped.push_back('\\');
+		}
+
+		escaped.push_back(character);
+	}
+
+	return escaped;
+}
+
+void benchmark::open_json_output(const std::string& path)
+{
+	const std::lock_guard lock(output_mutex);
+
+	json_output.open(path, std::ios::app);
+
+	if (!json_output)
+	{
+		throw std::runtime_error(fmt::format("failed to open {}", path));
+	}
+}
+
+void benchmark::report(const result_t& result)
+{
+	const double per_second = result.seconds > 0.0 ? static_cast<double>(result.iterations) / result.seconds : 0.0;
+
+	spdlog::info("{}: {} iterations in {:.3f}s ({:.0f}/s)", result.name, result.iterations, result.seconds, per_second);
+
+	for (const auto& [counter_name, value] : result.counters)
+	{
+		spdlog::info("    {}: {:.3f}", counter_name, value);
+	}
+
+	const std::lock_guard lock(output_mutex);
+
+	if (!json_output.is_open())
+	{
+		return;
+	}
+
+	const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+
+	std::string line = fmt::format(R"({{"timestamp":{},"name":"{}","iterations":{},"seconds":{:.6f},"per_second":{:.3f},"counters":{{)", timestamp.count(), escape_json(result.name), result.iterations, result.seconds, per_second);
+
+	for (std::uint64_t i = 0; i < result.counters.size(); i++)
+	{
+		const auto& [counter_name, value] = result.counters[i];
+
+		line += fmt::format(R"({}"{}":{:.6f})", i == 0 ? "" : ",", escape_json(counter_name), value);
+	}
+
+	line += "}}\n";
+
+	json_output << line << std::flush;
+}
+
+std::vector<benchmark::counter_t> benchmark::latency_percentiles(std::vector<std::uint64_t>& latencies)
+{
+	if (latencies.empty())
+	{
+		return { };
+	}
+
+	std::ranges::sort(latencies);
+
+	const auto percentile = [&latencies](const double fraction)
+	{
+		const auto index = std::min<std::uint64_t>(static_cast<std::uint64_t>(fraction * static_cast<double>(latencies.size())), latencies.size() - 1);
+
+		return static_cast<double>(latencies[index]) / 1000.0;
+	};
+
+	return { { "p50 us", percentile(0.5) }, { "p99 us", percentile(0.99) }, { "p999 us", percentile(0.999) } };
+}
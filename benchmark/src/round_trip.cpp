@@ -0,0 +1,181 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <runtime/runtime.hpp>
+#include <request/request.hpp>
+#include <response/response.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+static constexpr std::uint32_t server_thread_count = 2;
+static constexpr std::uint32_t max_client_thread_count = 4;
+static constexpr std::chrono::seconds run_duration(2);
+
+static constexpr std::uint64_t payload_sizes[] = { 0, 1024, 16384 };
+static constexpr std::uint32_t connection_counts[] = { 1, 16, 64 };
+
+// every connection has one request in flight, so a latency covers the request's own round trip and the time
+// it waited behind the thread's other connections, as it would behind other clients
+static void run_client(const std::uint16_t port, const std::uint32_t connection_count, const std::uint64_t payload_size, const std::atomic<std::uint8_t>& is_running, std::vector<std::uint64_t>& latencies)
+{
+	typedef std::chrono::steady_clock clock_t;
+
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+	const auto ssl_context = loopback::make_client_ssl_context();
+
+	std::vector<std::unique_ptr<boost_tcp_socket_t>> sockets;
+
+	for (std::uint32_t i = 0; i < connection_count; i++)
+	{
+		sockets.push_back(loopback::connect_client(io_context, ssl_context, port));
+	}
+
+	const std::vector<std::uint8_t> payload(payload_size, 0x5A);
+	const request::request_t request = request::construct::make_test_request(1, 0x12345, payload);
+
+	std::vector<clock_t::time_point> sent_at(connection_count);
+	std::vector<std::uint8_t> response_buffer;
+	request::correlation_id_t correlation_id = 0;
+
+	while (is_running.load(std::memory_order_relaxed))
+	{
+		for (std::uint32_t i = 0; i < connection_count; i++)
+		{
+			sent_at[i] = clock_t::now();
+
+			request::send_buffer(*sockets[i], request);
+		}
+
+		for (std::uint32_t i = 0; i < connection_count; i++)
+		{
+			if (!response::read_buffer(*sockets[i], response_buffer, correlation_id) || response_buffer.size() < payload_size)
+			{
+				throw std::runtime_error("round trip client failed to read a response");
+			}
+
+			latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - sent_at[i]).count());
+		}
+	}
+
+	for (const auto& socket : sockets)
+	{
+		socket->close();
+	}
+}
+
+static benchmark::result_t run_round_trips(const std::uint32_t connection_count, const std::uint64_t payload_size)
+{
+	const std::uint16_t port = loopback::find_free_port();
+	const auto server_ssl_context = loopback::make_server_ssl_context();
+
+	server_runtime_t runtime({ .thread_count = server_thread_count, .pin_threads = 0 });
+
+	std::thread runtime_thread(
+		[&runtime, &server_ssl_context, port]()
+		{
+			runtime.run(
+				[&server_ssl_context, port](const std::shared_ptr<boost::asio::io_context>& io_context, const std::uint8_t reuse_port) -> std::shared_ptr<connection_listener_t>
+				{
+					return std::make_shared<boost_connection_listener_t<client_connection_t>>(io_context, server_ssl_context, port, reuse_port);
+				}
+			);
+		}
+	);
+
+	const std::uint32_t client_thread_count = std::min(connection_count, max_client_thread_count);
+
+	std::atomic<std::uint8_t> is_running = 1;
+
+	std::vector<std::vector<std::uint64_t>> thread_latencies(client_thread_count);
+
+	// a client thread which fails stops the others and leaves its exception to be rethrown here once they are joined
+	std::vector<std::exception_ptr> thread_errors(client_thread_count);
+	std::vector<std::thread> client_threads;
+
+	for (std::uint32_t i = 0; i < client_thread_count; i++)
+	{
+		// the connections are spread as evenly as they divide
+		const std::uint32_t thread_connection_count = connection_count / client_thread_count + (i < connection_count % client_thread_count);
+
+		client_threads.emplace_back(
+			[port, thread_connection_count, payload_size, &is_running, &latencies = thread_latencies[i], &error = thread_errors[i]]()
+			{
+				try
+				{
+					run_client(port, thread_connection_count, payload_size, is_running, latencies);
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+
+					is_running = 0;
+				}
+			}
+		);
+	}
+
+	const benchmark::timer_t timer;
+
+	std::this_thread::sleep_for(run_duration);
+
+	is_running = 0;
+
+	for (std::thread& client_thread : client_threads)
+	{
+		client_thread.join();
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	runtime.stop();
+	runtime_thread.join();
+
+	for (const std::exception_ptr& error : thread_errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	std::vector<std::uint64_t> latencies;
+
+	for (const std::vector<std::uint64_t>& samples : thread_latencies)
+	{
+		latencies.insert(latencies.end(), samples.begin(), samples.end());
+	}
+
+	const std::uint64_t response_count = latencies.size();
+
+	return { .name = fmt::format("round trips ({} connection(s), {} byte payload)", connection_count, payload_size), .iterations = response_count, .seconds = seconds, .counters = benchmark::latency_percentiles(latencies) };
+}
+
+void benchmark::run_round_trip_benchmarks()
+{
+	const auto previous_level = spdlog::get_level();
+
+	// the request handlers log every request, which would otherwise dominate the measurement
+	spdlog::set_level(spdlog::level::warn);
+
+	std::vector<result_t> results;
+
+	for (const std::uint64_t payload_size : payload_sizes)
+	{
+		for (const std::uint32_t connection_count : connection_counts)
+		{
+			results.push_back(run_round_trips(connection_count, payload_size));
+		}
+	}
+
+	spdlog::set_level(previous_level);
+
+	// reported once the level is restored, as the results are logged at info
+	for (const result_t& result : results)
+	{
+		report(result);
+	}
+}
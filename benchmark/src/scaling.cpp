@@ -0,0 +1,142 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <runtime/runtime.hpp>
+#include <request/request.hpp>
+#include <response/response.hpp>
+#include <memory/pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static constexpr std::uint32_t client_thread_count = 8;
+static constexpr std::uint32_t connections_per_client_thread = 4;
+static constexpr std::chrono::seconds run_duration(3);
+
+static void run_client(const std::uint16_t port, const std::atomic<std::uint8_t>& is_running, std::atomic<std::uint64_t>& response_count)
+{
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+	const auto ssl_context = loopback::make_client_ssl_context();
+
+	std::vector<std::unique_ptr<boost_tcp_socket_t>> sockets;
+
+	for (std::uint32_t i = 0; i < connections_per_client_thread; i++)
+	{
+		sockets.push_back(loopback::connect_client(io_context, ssl_context, port));
+	}
+
+	const request::request_t request = request::construct::make_test_request(1, 0x12345);
+
+	std::vector<std::uint8_t> response_buffer;
+	request::correlation_id_t correlation_id = 0;
+	std::uint64_t thread_response_count = 0;
+
+	while (is_running.load(std::memory_order_relaxed))
+	{
+		for (const auto& socket : sockets)
+		{
+			request::send_buffer(*socket, request);
+		}
+
+		for (const auto& socket : sockets)
+		{
+			if (!response::read_buffer(*socket, response_buffer, correlation_id))
+			{
+				throw std::runtime_error("scaling client failed to read a response");
+			}
+
+			thread_response_count++;
+		}
+	}
+
+	response_count += thread_response_count;
+
+	for (const auto& socket : sockets)
+	{
+		socket->close();
+	}
+}
+
+static benchmark::result_t run_scaling(const std::uint32_t thread_count)
+{
+	const std::uint16_t port = loopback::find_free_port();
+	const auto server_ssl_context = loopback::make_server_ssl_context();
+
+	server_runtime_t runtime({ .thread_count = thread_count, .pin_threads = 0 });
+
+	std::thread runtime_thread(
+		[&runtime, &server_ssl_context, port]()
+		{
+			runtime.run(
+				[&server_ssl_context, port](const std::shared_ptr<boost::asio::io_context>& io_context, const std::uint8_t reuse_port) -> std::shared_ptr<connection_listener_t>
+				{
+					return std::make_shared<boost_connection_listener_t<client_connection_t>>(io_context, server_ssl_context, port, reuse_port);
+				}
+			);
+		}
+	);
+
+	std::atomic<std::uint8_t> is_running = 1;
+	std::atomic<std::uint64_t> response_count = 0;
+
+	std::vector<std::thread> client_threads;
+
+	for (std::uint32_t i = 0; i < client_thread_count; i++)
+	{
+		client_threads.emplace_back(run_client, port, std::cref(is_running), std::ref(response_count));
+	}
+
+	const memory::statistics_t statistics_before = memory::statistics();
+	const benchmark::timer_t timer;
+
+	std::this_thread::sleep_for(run_duration);
+
+	is_running = 0;
+
+	for (std::thread& client_thread : client_threads)
+	{
+		client_thread.join();
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	runtime.stop();
+	runtime_thread.join();
+
+	const memory::statistics_t statistics_after = memory::statistics();
+
+	// the client threads draw from the pool as well, so these cover both ends of each request
+	const double requests = static_cast<double>(std::max<std::uint64_t>(statistics_after.requests - statistics_before.requests, 1));
+	const double pooled_allocations = static_cast<double>(statistics_after.pooled_allocations - statistics_before.pooled_allocations);
+	const double heap_allocations = static_cast<double>(statistics_after.heap_allocations - statistics_before.heap_allocations);
+
+	return { .name = fmt::format("{} server thread(s)", runtime.thread_count()), .iterations = response_count.load(), .seconds = seconds, .counters = {
+		{ "pooled allocations per request", pooled_allocations / requests },
+		{ "pool misses per request", heap_allocations / requests }
+	} };
+}
+
+void benchmark::run_scaling_benchmarks()
+{
+	const auto previous_level = spdlog::get_level();
+
+	// the request handlers log every request, which would otherwise dominate the measurement
+	spdlog::set_level(spdlog::level::warn);
+
+	std::vector<result_t> results;
+
+	for (const std::uint32_t thread_count : { 1u, 2u, 4u, 8u })
+	{
+		results.push_back(run_scaling(thread_count));
+	}
+
+	spdlog::set_level(previous_level);
+
+	// reported once the level is restored, as the results are logged at info
+	for (const result_t& result : results)
+	{
+		report(result);
+	}
+}
@@ -0,0 +1,257 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <request/request.hpp>
+#include <response/response.hpp>
+#include <frame/frame.hpp>
+#include <schema/schema.hpp>
+#include <schema/request_generated.h>
+#include <schema/response_generated.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+static constexpr std::uint64_t payload_sizes[] = { 0, 256, 4096, 65536 };
+
+// larger payloads run fewer iterations, so every size moves roughly the same number of bytes
+static std::uint64_t iteration_count(const std::uint64_t payload_size)
+{
+	constexpr std::uint64_t byte_budget = 256 * 1024 * 1024;
+
+	return std::clamp<std::uint64_t>(byte_budget / (payload_size + 64), 10000, 1000000);
+}
+
+static benchmark::result_t run_serialise(const std::uint64_t payload_size)
+{
+	const std::uint64_t count = iteration_count(payload_size);
+	const std::vector<std::uint8_t> payload(payload_size, 0x5A);
+
+	std::uint64_t bytes = 0;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		const std::vector<std::uint8_t> body = serialisation::serialise(
+			[&payload](flatbuffers::FlatBufferBuilder& builder, const std::uint64_t key)
+			{
+				return Client::CreateTestRequest(builder, key, builder.CreateVector(payload.data(), payload.size()));
+			},
+			i
+		);
+
+		bytes += body.size();
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	return { .name = fmt::format("serialise test request body ({} byte payload)", payload_size), .iterations = count, .seconds = seconds, .counters = { { "bytes per body", static_cast<double>(bytes) / count } } };
+}
+
+static benchmark::result_t run_make_request(const std::uint64_t payload_size)
+{
+	const std::uint64_t count = iteration_count(payload_size);
+	const std::vector<std::uint8_t> payload(payload_size, 0x5A);
+
+	std::uint64_t bytes = 0;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		bytes += request::construct::make_test_request(i, i, payload).frame.size();
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	return { .name = fmt::format("make test request frame ({} byte payload)", payload_size), .iterations = count, .seconds = seconds, .counters = { { "bytes per frame", static_cast<double>(bytes) / count } } };
+}
+
+// the server's side of a request: the frame is parsed and its header verified, then the body is verified
+static benchmark::result_t run_verify(const std::uint64_t payload_size)
+{
+	const std::uint64_t count = iteration_count(payload_size);
+	const std::vector<std::uint8_t> payload(payload_size, 0x5A);
+
+	request::request_t request = request::construct::make_test_request(1, 0x12345, payload);
+
+	const std::span<std::uint8_t> buffer(request.frame.data(), request.frame.size());
+
+	std::uint64_t valid_count = 0;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		frame::parsed_frame_t request_frame = { };
+		std::uint64_t required_size = 0;
+
+		if (frame::parse<RequestHeader>(buffer, request_frame, required_size) == frame::parse_status_t::complete && serialisation::is_valid<Client::TestRequest>(request_frame.body))
+		{
+			valid_count++;
+		}
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	if (valid_count != count)
+	{
+		throw std::runtime_error("serialisation benchmark request failed to verify");
+	}
+
+	return { .name = fmt::format("parse and verify test request ({} byte payload)", payload_size), .iterations = count, .seconds = seconds, .counters = { } };
+}
+
+// only the frame header is parsed, the body is left unverified, so this is the per frame cost of the wire format itself,
+// the frames lie back to back as they would in a receive buffer
+static benchmark::result_t run_parse_header(const frame::wire_version_t version)
+{
+	constexpr std::uint64_t frame_count = 1024;
+	constexpr std::uint64_t pass_count = 10000;
+
+	std::vector<std::uint8_t> buffer;
+
+	for (std::uint64_t i = 0; i < frame_count; i++)
+	{
+		const request::request_t request = request::construct::make_test_request(i + 1, i, { }, version);
+
+		buffer.insert(buffer.end(), request.frame.data(), request.frame.data() + request.frame.size());
+	}
+
+	std::uint64_t checksum = 0;
+	std::uint64_t parsed_count = 0;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t pass = 0; pass < pass_count; pass++)
+	{
+		std::span<std::uint8_t> readable(buffer);
+
+		while (!readable.empty())
+		{
+			frame::parsed_frame_t request_frame = { };
+			std::uint64_t required_size = 0;
+
+			if (frame::parse<RequestHeader>(readable, request_frame, required_size) != frame::parse_status_t::complete)
+			{
+				throw std::runtime_error("serialisation benchmark frame failed to parse");
+			}
+
+			checksum += request_frame.header.correlation_id + request_frame.header.type;
+			parsed_count++;
+
+			readable = readable.subspan(request_frame.size);
+		}
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	// the checksum is used so the loop cannot be optimised away
+	if (checksum == 0)
+	{
+		throw std::runtime_error("serialisation benchmark frame failed to parse");
+	}
+
+	return { .name = fmt::format("parse v{} request frame header", static_cast<std::uint32_t>(version)), .iterations = parsed_count, .seconds = seconds, .counters = {
+		{ "ns per frame", seconds * 1e9 / static_cast<double>(parsed_count) },
+		{ "bytes per frame", static_cast<double>(buffer.size()) / frame_count }
+	} };
+}
+
+// verification is left out, this is only the cost of reaching the fields of a verified body
+static benchmark::result_t run_deserialise(const std::uint64_t payload_size)
+{
+	constexpr std::uint64_t count = 10000000;
+
+	const std::vector<std::uint8_t> payload(payload_size, 0x5A);
+
+	std::vector<std::uint8_t> body = serialisation::serialise(
+		[&payload](flatbuffers::FlatBufferBuilder& builder, const std::uint64_t key)
+		{
+			return Client::CreateTestRequest(builder, key, builder.CreateVector(payload.data(), payload.size()));
+		},
+		0x12345
+	);
+
+	std::uint64_t checksum = 0;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		const auto* test_request = serialisation::deserialise<Client::TestRequest>(body);
+
+		checksum += test_request->key() + test_request->payload()->size();
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	// the checksum is used so the loop cannot be optimised away
+	if (checksum == 0)
+	{
+		throw std::runtime_error("serialisation benchmark request failed to deserialise");
+	}
+
+	return { .name = fmt::format("deserialise test request ({} byte payload)", payload_size), .iterations = count, .seconds = seconds, .counters = { { "ns per request", seconds * 1e9 / count } } };
+}
+
+// response::read_buffer over plaintext loopback tcp, with the responses written from another thread
+static benchmark::result_t run_read_response(const std::uint64_t payload_size)
+{
+	const std::uint64_t count = iteration_count(payload_size) / 10;
+	const std::vector<std::uint8_t> payload(payload_size, 0x5A);
+
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+
+	auto [client, server] = loopback::make_plain_tcp_socket_pair(io_context);
+
+	const serialisation::frame_t response = response::construct::make_test_response(1, 0x56789, payload);
+
+	std::thread write_thread(
+		[&server, &response, count]()
+		{
+			for (std::uint64_t i = 0; i < count; i++)
+			{
+				if (!server->write(response.data(), response.size()))
+				{
+					break;
+				}
+			}
+		}
+	);
+
+	std::vector<std::uint8_t> response_buffer;
+	request::correlation_id_t correlation_id = 0;
+	std::uint64_t read_count = 0;
+
+	const benchmark::timer_t timer;
+
+	while (read_count < count && response::read_buffer(*client, response_buffer, correlation_id))
+	{
+		read_count++;
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	write_thread.join();
+
+	return { .name = fmt::format("read test response ({} byte payload)", payload_size), .iterations = read_count, .seconds = seconds, .counters = {
+		{ "MB/s", seconds > 0.0 ? static_cast<double>(read_count * response.size()) / seconds / 1e6 : 0.0 }
+	} };
+}
+
+void benchmark::run_serialisation_benchmarks()
+{
+	report(run_parse_header(frame::wire_version_t::v1));
+	report(run_parse_header(frame::wire_version_t::v2));
+
+	for (const std::uint64_t payload_size : payload_sizes)
+	{
+		report(run_serialise(payload_size));
+		report(run_make_request(payload_size));
+		report(run_verify(payload_size));
+		report(run_deserialise(payload_size));
+		report(run_read_response(payload_size));
+	}
+}
@@ -0,0 +1,150 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <runtime/runtime.hpp>
+#include <request/request.hpp>
+#include <session/session_pool.hpp>
+
+#include <future>
+#include <thread>
+
+static constexpr std::uint32_t session_count = 16;
+static constexpr std::uint64_t request_count = 2000;
+
+// resolves, connects and handshakes one connection after another, as every caller used to
+static benchmark::result_t run_serial_cold_start(const std::uint16_t port)
+{
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+	const auto ssl_context = loopback::make_client_ssl_context();
+
+	std::vector<std::unique_ptr<boost_tcp_socket_t>> sockets;
+
+	const benchmark::timer_t timer;
+
+	for (std::uint32_t i = 0; i < session_count; i++)
+	{
+		auto socket = std::make_unique<boost_tcp_socket_t>(io_context, ssl_context);
+
+		if (!socket->connect("localhost", std::to_string(port)) || !socket->handshake(socket_t::handshake_type_t::client))
+		{
+			throw std::runtime_error("session pool benchmark client failed to connect");
+		}
+
+		sockets.push_back(std::move(socket));
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	for (const auto& socket : sockets)
+	{
+		socket->close();
+	}
+
+	return { .name = "serial connect and handshake", .iterations = session_count, .seconds = seconds, .counters = { { "milliseconds until every connection is open", seconds * 1000.0 } } };
+}
+
+static benchmark::result_t run_pool_cold_start(const std::uint16_t port)
+{
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+	const auto work_guard = boost::asio::make_work_guard(*io_context);
+
+	std::thread io_thread(
+		[io_context]()
+		{
+			io_context->run();
+		}
+	);
+
+	auto options = client_session_pool_t::default_options;
+
+	options.session_count = session_count;
+
+	const auto pool = std::make_shared<client_session_pool_t>(io_context, loopback::make_client_ssl_context(), "localhost", std::to_string(port), options);
+
+	std::promise<std::uint8_t> started;
+
+	const benchmark::timer_t timer;
+
+	pool->start(
+		[&started](const std::uint8_t is_valid)
+		{
+			started.set_value(is_valid);
+		}
+	);
+
+	const std::uint8_t is_started = started.get_future().get();
+
+	const double seconds = timer.elapsed_seconds();
+
+	// the requests spread over the sessions by their pending count
+	std::vector<std::future<std::optional<std::vector<std::uint8_t>>>> responses;
+
+	for (std::uint64_t i = 0; i < request_count && is_started; i++)
+	{
+		responses.push_back(pool->acquire()->request(
+			[](const request::correlation_id_t correlation_id, const frame::wire_version_t version)
+			{
+				return request::construct::make_test_request(correlation_id, 0x12345, { }, version);
+			}
+		));
+	}
+
+	std::uint64_t answered_count = 0;
+
+	for (auto& response : responses)
+	{
+		answered_count += response.get().has_value();
+	}
+
+	const std::uint64_t open_count = pool->open_count();
+
+	pool->close();
+
+	io_context->stop();
+	io_thread.join();
+
+	return { .name = "session pool parallel connect and handshake", .iterations = session_count, .seconds = seconds, .counters = {
+		{ "milliseconds until every connection is open", seconds * 1000.0 },
+		{ "open sessions", static_cast<double>(open_count) },
+		{ "answered requests", static_cast<double>(answered_count) }
+	} };
+}
+
+void benchmark::run_session_pool_benchmarks()
+{
+	const std::uint16_t port = loopback::find_free_port();
+	const auto server_ssl_context = loopback::make_server_ssl_context();
+
+	server_runtime_t runtime({ .thread_count = 1, .pin_threads = 0 });
+
+	std::thread runtime_thread(
+		[&runtime, &server_ssl_context, port]()
+		{
+			runtime.run(
+				[&server_ssl_context, port](const std::shared_ptr<boost::asio::io_context>& io_context, const std::uint8_t reuse_port) -> std::shared_ptr<connection_listener_t>
+				{
+					return std::make_shared<boost_connection_listener_t<client_connection_t>>(io_context, server_ssl_context, port, reuse_port);
+				}
+			);
+		}
+	);
+
+	const auto previous_level = spdlog::get_level();
+
+	// the request handlers log every request, which would otherwise dominate the measurement
+	spdlog::set_level(spdlog::level::warn);
+
+	// the listener binds on the runtime's thread
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	const result_t serial_result = run_serial_cold_start(port);
+	const result_t pool_result = run_pool_cold_start(port);
+
+	spdlog::set_level(previous_level);
+
+	runtime.stop();
+	runtime_thread.join();
+
+	report(serial_result);
+	report(pool_result);
+}
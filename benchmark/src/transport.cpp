@@ -0,0 +1,136 @@
+#include "benchmark.hpp"
+#include "loopback/loopback.hpp"
+
+#include <thread>
+
+static constexpr std::uint64_t round_trip_count = 50000;
+static constexpr std::uint64_t message_size = 64;
+
+static constexpr std::uint64_t chunk_size = 64 * 1024;
+static constexpr std::uint64_t chunk_count = 4096;
+
+typedef std::function<loopback::transport_pair_t(const std::shared_ptr<boost::asio::io_context>& io_context)> make_transport_t;
+
+// the server echoes every message, so each iteration is one request/response round trip
+static benchmark::result_t run_round_trips(const std::string& name, const make_transport_t& make_transport)
+{
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+
+	auto [client, server] = make_transport(io_context);
+
+	std::thread echo_thread(
+		[&server]()
+		{
+			std::vector<std::uint8_t> message(message_size);
+
+			for (std::uint64_t i = 0; i < round_trip_count; i++)
+			{
+				if (!server->read(message.data(), message.size()) || !server->write(message.data(), message.size()))
+				{
+					break;
+				}
+			}
+		}
+	);
+
+	std::vector<std::uint8_t> message(message_size);
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < round_trip_count; i++)
+	{
+		if (!client->write(message.data(), message.size()) || !client->read(message.data(), message.size()))
+		{
+			break;
+		}
+	}
+
+	const double seconds = timer.elapsed_seconds();
+
+	echo_thread.join();
+
+	return { .name = name, .iterations = round_trip_count, .seconds = seconds, .counters = { { "us per round trip", seconds * 1e6 / static_cast<double>(round_trip_count) } } };
+}
+
+static benchmark::result_t run_bulk_transfer(const std::string& name, const make_transport_t& make_transport)
+{
+	const auto io_context = std::make_shared<boost::asio::io_context>();
+
+	auto [client, server] = make_transport(io_context);
+
+	std::thread drain_thread(
+		[&client]()
+		{
+			std::vector<std::uint8_t> chunk(chunk_size);
+
+			for (std::uint64_t i = 0; i < chunk_count; i++)
+			{
+				if (!client->read(chunk.data(), chunk.size()))
+				{
+					break;
+				}
+			}
+		}
+	);
+
+	const std::vector<std::uint8_t> chunk(chunk_size, 0x5A);
+
+	const benchmark::timer_t timer;
+
+	for (std::uint64_t i = 0; i < chunk_count; i++)
+	{
+		if (!server->write(chunk.data(), chunk.size()))
+		{
+			break;
+		}
+	}
+
+	drain_thread.join();
+
+	const double seconds = timer.elapsed_seconds();
+	const double mebibytes = static_cast<double>(chunk_size * chunk_count) / (1024.0 * 1024.0);
+
+	return { .name = name, .iterations = chunk_count, .seconds = seconds, .counters = { { "MiB/s", mebibytes / seconds } } };
+}
+
+static loopback::transport_pair_t make_tls_transport(const std::shared_ptr<boost::asio::io_context>& io_context)
+{
+	auto [client, server] = loopback::make_socket_pair(io_context, loopback::make_server_ssl_context(), loopback::make_client_ssl_context());
+
+	return { .client = std::move(client), .server = std::move(server) };
+}
+
+void benchmark::run_transport_benchmarks()
+{
+	std::vector<std::pair<std::string, make_transport_t>> transports = { { "tls over tcp", make_tls_transport }, { "plaintext tcp", loopback::make_plain_tcp_socket_pair } };
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	transports.emplace_back("unix domain socket", loopback::make_unix_socket_pair);
+#endif
+
+#ifdef __linux__
+	transports.emplace_back("shared memory rings",
+		[](const std::shared_ptr<boost::asio::io_context>& io_context)
+		{
+			return loopback::make_shm_socket_pair(io_context);
+		}
+	);
+
+	// both ends spinning on one core only take turns at wasting it
+	if (std::thread::hardware_concurrency() > 1)
+	{
+		transports.emplace_back("shared memory rings with busy polling",
+			[](const std::shared_ptr<boost::asio::io_context>& io_context)
+			{
+				return loopback::make_shm_socket_pair(io_context, std::chrono::microseconds(50));
+			}
+		);
+	}
+#endif
+
+	for (const auto& [transport_name, make_transport] : transports)
+	{
+		report(run_round_trips(transport_name + " round trips", make_transport));
+		report(run_bulk_transfer(transport_name + " bulk transfer", make_transport));
+	}
+}
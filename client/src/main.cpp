@@ -1,74 +1,276 @@
 #include <request/request.hpp>
-#include <response/response.hpp>
+#include <session/session_pool.hpp>
+#include <logging/logging.hpp>
+#include <schema/request_generated.h>
 #include <schema/response_generated.h>
 
 #include <spdlog/spdlog.h>
 
-void send_test_request(socket_t& socket, const std::uint64_t request_key)
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+static void send_test_requests(client_session_t& session)
 {
-	const auto [request_header_size, request_buffer] = request::construct::make_test_request(request_key);
+	constexpr std::uint64_t request_key = 0x12345;
+	constexpr std::uint64_t request_count = 4;
+
+	std::vector<std::future<std::optional<std::vector<std::uint8_t>>>> responses;
+
+	// every request is in flight before the first response is awaited
+	for (std::uint64_t i = 0; i < request_count; i++)
+	{
+		responses.push_back(session.request(
+			[key = request_key + i](const request::correlation_id_t correlation_id, const frame::wire_version_t version)
+			{
+				return request::construct::make_test_request(correlation_id, key, { }, version);
+			}
+		));
+	}
+
+	for (auto& response : responses)
+	{
+		std::optional<std::vector<std::uint8_t>> response_buffer = response.get();
+
+		if (response_buffer.has_value() && serialisation::is_valid<Client::TestResponse>(*response_buffer))
+		{
+			const auto* test_response = serialisation::deserialise<Client::TestResponse>(*response_buffer);
 
-	request::send_buffer(socket, request_buffer, request_header_size);
+			spdlog::info("test response key: 0x{:X}", test_response->key());
+		}
+		else
+		{
+			spdlog::error("failed to receive test response");
+		}
+	}
 }
 
-void receive_test_response(socket_t& socket)
+// the upper bound of the bucket holding the percentile
+static std::uint64_t histogram_percentile(const Client::Histogram* const histogram, const double percentile)
 {
-	std::vector<std::uint8_t> response_buffer = { };
+	if (histogram == nullptr || histogram->upper_bounds() == nullptr || histogram->counts() == nullptr || histogram->total_count() == 0)
+	{
+		return 0;
+	}
+
+	const auto count_at_percentile = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(histogram->total_count())));
+
+	std::uint64_t cumulative_count = 0;
 
-	const auto test_response = response::read_response<Client::TestResponse>(socket, response_buffer);
+	for (std::uint32_t i = 0; i < std::min(histogram->upper_bounds()->size(), histogram->counts()->size()); i++)
+	{
+		cumulative_count += histogram->counts()->Get(i);
+
+		if (cumulative_count >= count_at_percentile)
+		{
+			return std::min(histogram->upper_bounds()->Get(i), histogram->max());
+		}
+	}
 
-	spdlog::info("test response key: 0x{:X}", test_response->key());
+	return histogram->max();
+}
+
+static void print_server_stats(client_session_t& session)
+{
+	std::optional<std::vector<std::uint8_t>> response_buffer = session.request(request::construct::make_stats_request).get();
+
+	if (!response_buffer.has_value() || !serialisation::is_valid<Client::StatsResponse>(*response_buffer))
+	{
+		spdlog::error("failed to receive server stats");
+
+		return;
+	}
+
+	const auto* stats = serialisation::deserialise<Client::StatsResponse>(*response_buffer);
+
+	spdlog::info("server accepted {} connections, {} handshakes succeeded and {} failed, {} bytes in and {} bytes out",
+		stats->accepted_connections(), stats->handshake_successes(), stats->handshake_failures(), stats->bytes_in(), stats->bytes_out());
+
+	spdlog::info("server refused {} oversized frames and paused reading {} times for a connection's budget and {} times for the global one",
+		stats->oversized_frames(), stats->connection_budget_pauses(), stats->global_budget_pauses());
+
+	if (stats->request_types() == nullptr)
+	{
+		return;
+	}
+
+	for (const Client::RequestTypeStats* const request_type : *stats->request_types())
+	{
+		spdlog::info("request type {}: {} requests, p99 handler latency {} ns, p99 end to end latency {} ns",
+			request_type->request_id(), request_type->count(), histogram_percentile(request_type->handler_latency_ns(), 99.0), histogram_percentile(request_type->end_to_end_latency_ns(), 99.0));
+	}
 }
 
 static void set_up_ssl_context(ssl_context_t& ssl_context)
 {
 	ssl_context.require_peer_verification();
 
+	// tls 1.3 is negotiated with peers that support it for its 1-rtt handshake
+	ssl_context.set_protocol_versions(ssl_context_t::protocol_version_t::tls_1_2, ssl_context_t::protocol_version_t::tls_1_3);
+
 	ssl_context.load_verify_file("certificate_authority.pem");
 	ssl_context.use_certificate("client_certificate.pem", ssl_context_t::crypto_file_format_t::pem);
 	ssl_context.use_private_key("client_private_key.pem", ssl_context_t::crypto_file_format_t::pem);
 	ssl_context.use_tmp_dh_file("dhparams.pem");
+
+	ssl_context.enable_session_reuse();
+}
+
+// a test request is the cheapest round trip the server offers
+static void check_session_health(client_session_t& session, const async_callback_t& handler)
+{
+	session.async_request(
+		[](const request::correlation_id_t correlation_id, const frame::wire_version_t version)
+		{
+			return request::construct::make_test_request(correlation_id, 0, { }, version);
+		},
+		[handler](const std::uint8_t is_valid, const std::span<std::uint8_t>)
+		{
+			handler(is_valid);
+		}
+	);
+}
+
+// the server agrees if its configured codec is among these, bodies under min_size are sent uncompressed
+static void negotiate_compression(client_session_t& session)
+{
+	const std::vector<compression::options_t> offered = {
+		{ .codec = compression::codec_t::zstd, .level = 3, .min_size = 512 },
+		{ .codec = compression::codec_t::lz4, .level = 1, .min_size = 512 }
+	};
+
+	std::promise<compression::codec_t> negotiated;
+
+	session.negotiate_compression(offered,
+		[&negotiated](const compression::codec_t codec)
+		{
+			negotiated.set_value(codec);
+		}
+	);
+
+	spdlog::info("negotiated compression codec {}", static_cast<std::uint32_t>(negotiated.get_future().get()));
 }
 
-static void connect_to_server(socket_t& socket)
+// streams a body far larger than a chunk through the echo route, neither end holds more than a window of it
+static void echo_stream(client_session_t& session)
 {
-	if (socket.connect("127.0.0.1", "2457"))
+	constexpr std::uint64_t body_size = 16 * 1024 * 1024;
+
+	std::uint64_t sent_size = 0;
+	std::uint64_t echoed_size = 0;
+	std::uint8_t is_echoed_intact = 1;
+
+	// byte i of the body is i mod 251, so the echo can be checked without keeping the body
+	const auto body_byte = [](const std::uint64_t i)
 	{
-		if (socket.handshake(socket_t::handshake_type_t::client))
+		return static_cast<std::uint8_t>(i % 251);
+	};
+
+	std::promise<std::uint8_t> echoed;
+
+	session.async_stream_request(Client::RequestId_Echo,
+		[&sent_size, body_byte](const std::span<std::uint8_t> buffer)
 		{
-			spdlog::info("handshake was successful");
+			const std::uint64_t size = std::min<std::uint64_t>(buffer.size(), body_size - sent_size);
+
+			for (std::uint64_t i = 0; i < size; i++)
+			{
+				buffer[i] = body_byte(sent_size + i);
+			}
 
-			constexpr std::uint64_t request_key = 0x12345;
+			sent_size += size;
 
-			send_test_request(socket, request_key);
+			return size;
+		},
+		[&echoed_size, &is_echoed_intact, body_byte](const std::span<const std::uint8_t> chunk)
+		{
+			for (std::uint64_t i = 0; i < chunk.size(); i++)
+			{
+				is_echoed_intact &= chunk[i] == body_byte(echoed_size + i);
+			}
+
+			echoed_size += chunk.size();
 
-			receive_test_response(socket);
+			return is_echoed_intact;
+		},
+		[&echoed](const std::uint8_t is_valid)
+		{
+			echoed.set_value(is_valid);
 		}
-		else
+	);
+
+	if (echoed.get_future().get() && echoed_size == body_size)
+	{
+		spdlog::info("echoed a {} byte stream", echoed_size);
+	}
+	else
+	{
+		spdlog::error("failed to echo stream, {} of {} bytes came back", echoed_size, body_size);
+	}
+}
+
+static void connect_to_server(const std::shared_ptr<boost::asio::io_context>& io_context, const std::shared_ptr<boost_ssl_context_t>& ssl_context)
+{
+	auto options = client_session_pool_t::default_options;
+
+	// the server answers each session in the format it opened with
+	options.wire_version = frame::wire_version_t::v2;
+
+	const auto pool = std::make_shared<client_session_pool_t>(io_context, ssl_context, "127.0.0.1", "2457", options);
+
+	pool->set_health_check(check_session_health);
+
+	std::promise<std::uint8_t> started;
+
+	pool->start(
+		[&started](const std::uint8_t is_valid)
+		{
+			started.set_value(is_valid);
+		}
+	);
+
+	std::thread io_thread(
+		[io_context]()
 		{
-			spdlog::error("failed to handshake");
+			io_context->run();
 		}
+	);
+
+	const std::shared_ptr<client_session_t> session = started.get_future().get() ? pool->acquire() : nullptr;
+
+	if (session)
+	{
+		spdlog::info("connected {} sessions", pool->open_count());
+
+		negotiate_compression(*session);
+		send_test_requests(*session);
+		echo_stream(*session);
+		print_server_stats(*session);
 	}
 	else
 	{
 		spdlog::error("failed to connect to server");
 	}
+
+	pool->close();
+
+	io_thread.join();
 }
 
 std::int32_t main()
 {
+	logging::start_async();
+
 	try
 	{
 		spdlog::info("client");
 
 		const auto io_context = std::make_shared<boost::asio::io_context>();
-		const auto ssl_context = std::make_shared<boost_ssl_context_t>(boost_ssl_context_t::ssl_method_t::tlsv12_client);
+		const auto ssl_context = std::make_shared<boost_ssl_context_t>(boost_ssl_context_t::ssl_method_t::tls_client);
 
 		set_up_ssl_context(*ssl_context);
 
-		boost_tcp_socket_t socket(io_context, ssl_context);
-
-		connect_to_server(socket);
+		connect_to_server(io_context, ssl_context);
 
 		std::system("pause");
 	}
@@ -77,5 +279,7 @@ std::int32_t main()
 		spdlog::error(e.what());
 	}
 
+	logging::stop();
+
 	return 0;
 }
@@ -0,0 +1,187 @@
+#include "generator.hpp"
+
+#include <request/request.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+void step_result_t::merge(const step_result_t& other)
+{
+	latencies.merge(other.latencies);
+
+	sent_count += other.sent_count;
+	completed_count += other.completed_count;
+	error_count += other.error_count;
+}
+
+load_worker_t::load_worker_t(const load_options_t& options, std::shared_ptr<boost_ssl_context_t> ssl_context, const std::uint32_t connection_count)
+	:	options_(options),
+		ssl_context_(std::move(ssl_context)),
+		connection_count_(connection_count),
+		io_context_(std::make_shared<asio_context_t>(1)),
+		work_guard_(boost::asio::make_work_guard(*io_context_)),
+		payload_(options.payload_size, 0x5A),
+		step_result_({ .latencies = histogram_t(highest_latency), .sent_count = 0, .completed_count = 0, .error_count = 0 })
+{
+	thread_ = std::thread(
+		[io_context = io_context_]()
+		{
+			io_context->run();
+		}
+	);
+}
+
+load_worker_t::~load_worker_t()
+{
+	stop();
+}
+
+std::uint32_t load_worker_t::connect()
+{
+	for (std::uint32_t i = 0; i < connection_count_; i++)
+	{
+		auto socket = std::make_unique<boost_tcp_socket_t>(io_context_, ssl_context_);
+
+		if (!socket->connect(options_.host, options_.service) || !socket->handshake(socket_t::handshake_type_t::client))
+		{
+			continue;
+		}
+
+		auto session = std::make_shared<client_session_t>(io_context_, std::move(socket));
+
+		session->set_wire_version(options_.wire_version);
+		session->start();
+
+		sessions_.push_back(std::move(session));
+	}
+
+	return static_cast<std::uint32_t>(sessions_.size());
+}
+
+std::future<step_result_t> load_worker_t::run_step(const double requests_per_second, const std::chrono::nanoseconds duration)
+{
+	const auto promise = std::make_shared<std::promise<step_result_t>>();
+
+	std::future<step_result_t> result = promise->get_future();
+
+	boost::asio::co_spawn(*io_context_, co_run_step(requests_per_second, duration, promise), boost::asio::detached);
+
+	return result;
+}
+
+void load_worker_t::stop()
+{
+	for (const std::shared_ptr<client_session_t>& session : sessions_)
+	{
+		session->close();
+	}
+
+	sessions_.clear();
+
+	work_guard_.reset();
+
+	if (thread_.joinable())
+	{
+		thread_.join();
+	}
+}
+
+awaitable_t<void> load_worker_t::co_run_step(const double requests_per_second, const std::chrono::nanoseconds duration, const std::shared_ptr<std::promise<step_result_t>> promise)
+{
+	typedef std::chrono::steady_clock clock_t;
+
+	// responses to a step which timed out are ignored when they turn up during a later one
+	step_index_++;
+	step_result_.latencies.reset();
+	step_result_.sent_count = 0;
+	step_result_.completed_count = 0;
+	step_result_.error_count = 0;
+	outstanding_count_ = 0;
+
+	boost::asio::steady_timer timer(*io_context_);
+	boost::system::error_code error_code = { };
+
+	const std::chrono::nanoseconds interval(static_cast<std::int64_t>(1e9 / std::max(requests_per_second, 1e-3)));
+
+	const clock_t::time_point start_time = clock_t::now();
+	const clock_t::time_point end_time = start_time + duration;
+
+	std::uint64_t request_index = 0;
+	clock_t::time_point intended_time = start_time;
+
+	while (intended_time < end_time)
+	{
+		timer.expires_at(intended_time);
+
+		co_await timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+		// every request whose time has come is sent, so after a stall the schedule catches up in a burst
+		// as independent clients would, rather than quietly sending fewer requests
+		const clock_t::time_point now = clock_t::now();
+
+		while (intended_time <= now && intended_time < end_time)
+		{
+			send(intended_time);
+
+			request_index++;
+			intended_time = start_time + request_index * interval;
+		}
+	}
+
+	const clock_t::time_point drain_deadline = clock_t::now() + options_.drain_timeout;
+
+	while (outstanding_count_ != 0 && clock_t::now() < drain_deadline)
+	{
+		timer.expires_after(std::chrono::milliseconds(1));
+
+		co_await timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+	}
+
+	step_result_.error_count += outstanding_count_;
+
+	promise->set_value(step_result_);
+}
+
+void load_worker_t::send(const std::chrono::steady_clock::time_point intended_time)
+{
+	step_result_.sent_count++;
+
+	if (sessions_.empty())
+	{
+		step_result_.error_count++;
+
+		return;
+	}
+
+	const std::shared_ptr<client_session_t>& session = sessions_[next_session_++ % sessions_.size()];
+
+	outstanding_count_++;
+
+	session->async_request(
+		[this, key = step_result_.sent_count](const request::correlation_id_t correlation_id, const frame::wire_version_t version)
+		{
+			return request::construct::make_test_request(correlation_id, key, payload_, version);
+		},
+		// the session runs its handlers on this worker's io_context, so they never race the step
+		[this, step_index = step_index_, intended_time](const std::uint8_t is_valid, const std::span<std::uint8_t>)
+		{
+			if (step_index != step_index_)
+			{
+				return;
+			}
+
+			outstanding_count_--;
+
+			if (!is_valid)
+			{
+				step_result_.error_count++;
+
+				return;
+			}
+
+			step_result_.completed_count++;
+			step_result_.latencies.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - intended_time).count());
+		}
+	);
+}
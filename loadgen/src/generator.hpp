@@ -0,0 +1,89 @@
+#pragma once
+#include "histogram.hpp"
+
+#include <session/session.hpp>
+#include <network/socket.hpp>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct load_options_t
+{
+	std::string host = "127.0.0.1";
+	std::string service = "2457";
+
+	std::uint32_t connection_count = 64;
+	std::uint32_t thread_count = 4;
+
+	// the final rate, reached in step_count equal steps, each held for step_duration
+	double requests_per_second = 10000.0;
+	std::uint32_t step_count = 1;
+	std::chrono::seconds step_duration = std::chrono::seconds(10);
+
+	std::uint64_t payload_size = 0;
+
+	frame::wire_version_t wire_version = frame::wire_version_t::v1;
+
+	// requests still outstanding this long after a step has ended are counted as errors
+	std::chrono::seconds drain_timeout = std::chrono::seconds(5);
+};
+
+struct step_result_t
+{
+	histogram_t latencies;
+	std::uint64_t sent_count;
+	std::uint64_t completed_count;
+	std::uint64_t error_count;
+
+	void merge(const step_result_t& other);
+};
+
+// latencies are recorded in nanoseconds up to this, anything slower is clamped to it
+constexpr std::uint64_t highest_latency = std::chrono::nanoseconds(std::chrono::minutes(1)).count();
+
+// one thread sending its share of the target rate over its share of the connections, on its own io_context
+// every request has an intended send time on a fixed schedule and its latency is measured from then rather than from
+// when it was actually sent, so a stall in the server or in this thread is charged to every request it delayed
+// instead of only to the one that hit it, which is the coordinated omission a closed loop client suffers from
+class load_worker_t
+{
+public:
+	typedef boost::asio::io_context asio_context_t;
+
+	explicit load_worker_t(const load_options_t& options, std::shared_ptr<boost_ssl_context_t> ssl_context, std::uint32_t connection_count);
+	~load_worker_t();
+
+	// connects and handshakes every connection, returns how many opened
+	std::uint32_t connect();
+
+	// sends at requests_per_second for duration and then waits for the outstanding responses,
+	// the result is ready once they have all arrived or the drain timeout has passed
+	std::future<step_result_t> run_step(double requests_per_second, std::chrono::nanoseconds duration);
+
+	void stop();
+
+protected:
+	awaitable_t<void> co_run_step(double requests_per_second, std::chrono::nanoseconds duration, std::shared_ptr<std::promise<step_result_t>> promise);
+
+	void send(std::chrono::steady_clock::time_point intended_time);
+
+	const load_options_t& options_;
+	std::shared_ptr<boost_ssl_context_t> ssl_context_;
+	std::uint32_t connection_count_;
+
+	std::shared_ptr<asio_context_t> io_context_;
+	boost::asio::executor_work_guard<asio_context_t::executor_type> work_guard_;
+	std::thread thread_;
+
+	std::vector<std::uint8_t> payload_;
+	std::vector<std::shared_ptr<client_session_t>> sessions_;
+
+	// only touched on the io_context
+	step_result_t step_result_;
+	std::uint64_t step_index_ = 0;
+	std::uint64_t next_session_ = 0;
+	std::uint64_t outstanding_count_ = 0;
+};
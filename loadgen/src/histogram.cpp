@@ -0,0 +1,161 @@
+#include "histogram.hpp"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+histogram_t::histogram_t(const std::uint64_t highest_value)
+	:	highest_value_(std::max(highest_value, sub_bucket_count))
+{
+	// the first bucket covers every sub bucket, each bucket after it only the upper half, as its lower half
+	// is covered at twice the precision by the bucket before
+	counts_.resize(counts_index(highest_value_) + 1);
+}
+
+std::uint64_t histogram_t::counts_index(const std::uint64_t value)
+{
+	const std::uint64_t bucket_index = 64 - std::countl_zero(value | sub_bucket_mask) - (sub_bucket_half_count_magnitude + 1);
+	const std::uint64_t sub_bucket_index = value >> bucket_index;
+
+	return ((bucket_index + 1) << sub_bucket_half_count_magnitude) + sub_bucket_index - sub_bucket_half_count;
+}
+
+std::uint64_t histogram_t::lowest_equivalent_value(const std::uint64_t index)
+{
+	if (index < sub_bucket_count)
+	{
+		return index;
+	}
+
+	const std::uint64_t bucket_index = (index >> sub_bucket_half_count_magnitude) - 1;
+	const std::uint64_t sub_bucket_index = (index & (sub_bucket_half_count - 1)) + sub_bucket_half_count;
+
+	return sub_bucket_index << bucket_index;
+}
+
+std::uint64_t histogram_t::highest_equivalent_value(const std::uint64_t index)
+{
+	if (index < sub_bucket_count)
+	{
+		return index;
+	}
+
+	const std::uint64_t bucket_index = (index >> sub_bucket_half_count_magnitude) - 1;
+
+	return lowest_equivalent_value(index) + (1ull << bucket_index) - 1;
+}
+
+void histogram_t::record(std::uint64_t value)
+{
+	value = std::min(value, highest_value_);
+
+	counts_[counts_index(value)]++;
+
+	total_count_++;
+	max_ = std::max(max_, value);
+	sum_ += static_cast<double>(value);
+}
+
+void histogram_t::merge(const histogram_t& other)
+{
+	for (std::uint64_t i = 0; i < std::min(counts_.size(), other.counts_.size()); i++)
+	{
+		counts_[i] += other.counts_[i];
+	}
+
+	total_count_ += other.total_count_;
+	max_ = std::max(max_, other.max_);
+	sum_ += other.sum_;
+}
+
+void histogram_t::reset()
+{
+	std::ranges::fill(counts_, 0);
+
+	total_count_ = 0;
+	max_ = 0;
+	sum_ = 0.0;
+}
+
+std::uint64_t histogram_t::value_at_percentile(const double percentile) const
+{
+	if (total_count_ == 0)
+	{
+		return 0;
+	}
+
+	const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+	const std::uint64_t count_at_percentile = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(total_count_))), 1);
+
+	std::uint64_t cumulative_count = 0;
+
+	for (std::uint64_t i = 0; i < counts_.size(); i++)
+	{
+		cumulative_count += counts_[i];
+
+		if (cumulative_count >= count_at_percentile)
+		{
+			return std::min(highest_equivalent_value(i), max_);
+		}
+	}
+
+	return max_;
+}
+
+std::uint64_t histogram_t::total_count() const
+{
+	return total_count_;
+}
+
+std::uint64_t histogram_t::max() const
+{
+	return max_;
+}
+
+double histogram_t::mean() const
+{
+	return total_count_ != 0 ? sum_ / static_cast<double>(total_count_) : 0.0;
+}
+
+void histogram_t::write_percentile_distribution(std::ostream& stream, const double value_scale) const
+{
+	// each halving of the distance to 100% is reported in this many steps, so the tail gets as many lines as the body
+	constexpr double ticks_per_half_distance = 5.0;
+
+	stream << fmt::format("{:>12} {:>14} {:>10} {:>14}\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+
+	double percentile = 0.0;
+
+	while (percentile < 100.0)
+	{
+		const std::uint64_t value = value_at_percentile(percentile);
+
+		std::uint64_t count_at_or_below = 0;
+
+		for (std::uint64_t i = 0; i < counts_.size() && lowest_equivalent_value(i) <= value; i++)
+		{
+			count_at_or_below += counts_[i];
+		}
+
+		const double fraction = static_cast<double>(count_at_or_below) / static_cast<double>(std::max<std::uint64_t>(total_count_, 1));
+
+		if (fraction >= 1.0)
+		{
+			break;
+		}
+
+		stream << fmt::format("{:12.3f} {:14.12f} {:10} {:14.2f}\n", static_cast<double>(value) / value_scale, fraction, count_at_or_below, 1.0 / (1.0 - fraction));
+
+		const double half_distance = std::pow(2.0, std::floor(std::log2(100.0 / (100.0 - percentile))) + 1.0);
+
+		percentile += 100.0 / (ticks_per_half_distance * half_distance);
+	}
+
+	stream << fmt::format("{:12.3f} {:14.12f} {:10}\n", static_cast<double>(max_) / value_scale, 1.0, total_count_);
+
+	stream << fmt::format("#[Mean    = {:12.3f}]\n", mean() / value_scale);
+	stream << fmt::format("#[Max     = {:12.3f}, Total count    = {:12}]\n", static_cast<double>(max_) / value_scale, total_count_);
+	stream << fmt::format("#[Buckets = {:12}, SubBuckets     = {:12}]\n", counts_.size() / sub_bucket_half_count, sub_bucket_count);
+}
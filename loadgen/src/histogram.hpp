@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// a high dynamic range histogram after HdrHistogram: every value up to highest_value is recorded with three significant
+// decimal digits, in buckets that double in width while their sub buckets keep a fixed relative precision,
+// so a latency of a microsecond and one of a minute are both recorded to within 0.1% in a fixed amount of memory
+class histogram_t
+{
+public:
+	explicit histogram_t(std::uint64_t highest_value);
+
+	// values above highest_value are clamped to it
+	void record(std::uint64_t value);
+
+	// both histograms must have been created with the same highest value
+	void merge(const histogram_t& other);
+
+	void reset();
+
+	// the highest value that is equivalent to the one below which percentile percent of the recorded values fall
+	[[nodiscard]] std::uint64_t value_at_percentile(double percentile) const;
+
+	[[nodiscard]] std::uint64_t total_count() const;
+	[[nodiscard]] std::uint64_t max() const;
+	[[nodiscard]] double mean() const;
+
+	// writes the distribution in HdrHistogram's percentile format, which its plotting tools read,
+	// with values divided by value_scale, such as 1000 for nanoseconds recorded and microseconds written
+	void write_percentile_distribution(std::ostream& stream, double value_scale) const;
+
+protected:
+	// 2048 sub buckets hold three significant decimal digits
+	static constexpr std::uint32_t sub_bucket_half_count_magnitude = 10;
+	static constexpr std::uint64_t sub_bucket_half_count = 1ull << sub_bucket_half_count_magnitude;
+	static constexpr std::uint64_t sub_bucket_count = sub_bucket_half_count * 2;
+	static constexpr std::uint64_t sub_bucket_mask = sub_bucket_count - 1;
+
+	[[nodiscard]] static std::uint64_t counts_index(std::uint64_t value);
+
+	// the lowest and highest values recorded in the same count as the one at index
+	[[nodiscard]] static std::uint64_t lowest_equivalent_value(std::uint64_t index);
+	[[nodiscard]] static std::uint64_t highest_equivalent_value(std::uint64_t index);
+
+	std::uint64_t highest_value_;
+	std::vector<std::uint64_t> counts_;
+	std::uint64_t total_count_ = 0;
+	std::uint64_t max_ = 0;
+	double sum_ = 0.0;
+};
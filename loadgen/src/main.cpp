@@ -0,0 +1,216 @@
+#include "generator.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <charconv>
+#include <fstream>
+#include <string_view>
+
+static void set_up_ssl_context(ssl_context_t& ssl_context)
+{
+	ssl_context.require_peer_verification();
+
+	ssl_context.set_protocol_versions(ssl_context_t::protocol_version_t::tls_1_2, ssl_context_t::protocol_version_t::tls_1_3);
+
+	ssl_context.load_verify_file("certificate_authority.pem");
+	ssl_context.use_certificate("client_certificate.pem", ssl_context_t::crypto_file_format_t::pem);
+	ssl_context.use_private_key("client_private_key.pem", ssl_context_t::crypto_file_format_t::pem);
+	ssl_context.use_tmp_dh_file("dhparams.pem");
+
+	ssl_context.enable_session_reuse();
+}
+
+template <class t>
+static t parse_number(const std::string_view& text)
+{
+	t value = { };
+
+	const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+	if (error != std::errc() || end != text.data() + text.size())
+	{
+		throw std::invalid_argument(fmt::format("{} is not a number", text));
+	}
+
+	return value;
+}
+
+static void print_usage()
+{
+	spdlog::info("loadgen [--host <host>] [--port <port>] [--connections <n>] [--threads <n>] [--rate <requests per second>] "
+		"[--steps <n>] [--step-duration <seconds>] [--payload <bytes>] [--wire-version <1|2>] [--hgrm <path prefix>]");
+}
+
+// returns 0 if the arguments are invalid
+static std::uint8_t parse_arguments(const std::int32_t argument_count, const char* const* const arguments, load_options_t& options, std::string& hgrm_prefix)
+{
+	for (std::int32_t i = 1; i < argument_count; i++)
+	{
+		const std::string_view name = arguments[i];
+
+		if (i + 1 >= argument_count)
+		{
+			return 0;
+		}
+
+		const std::string_view value = arguments[++i];
+
+		if (name == "--host")
+		{
+			options.host = value;
+		}
+		else if (name == "--port")
+		{
+			options.service = value;
+		}
+		else if (name == "--connections")
+		{
+			options.connection_count = parse_number<std::uint32_t>(value);
+		}
+		else if (name == "--threads")
+		{
+			options.thread_count = parse_number<std::uint32_t>(value);
+		}
+		else if (name == "--rate")
+		{
+			options.requests_per_second = parse_number<double>(value);
+		}
+		else if (name == "--steps")
+		{
+			options.step_count = parse_number<std::uint32_t>(value);
+		}
+		else if (name == "--step-duration")
+		{
+			options.step_duration = std::chrono::seconds(parse_number<std::uint32_t>(value));
+		}
+		else if (name == "--payload")
+		{
+			options.payload_size = parse_number<std::uint64_t>(value);
+		}
+		else if (name == "--wire-version")
+		{
+			const auto wire_version = parse_number<std::uint8_t>(value);
+
+			if (wire_version != static_cast<std::uint8_t>(frame::wire_version_t::v1) && wire_version != static_cast<std::uint8_t>(frame::wire_version_t::v2))
+			{
+				return 0;
+			}
+
+			options.wire_version = static_cast<frame::wire_version_t>(wire_version);
+		}
+		else if (name == "--hgrm")
+		{
+			hgrm_prefix = value;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+
+	return options.connection_count != 0 && options.thread_count != 0 && options.step_count != 0 && options.requests_per_second > 0.0;
+}
+
+static void report_step(const double target_rate, const std::chrono::seconds duration, const step_result_t& result)
+{
+	const double seconds = static_cast<double>(duration.count());
+	const double error_rate = result.sent_count != 0 ? static_cast<double>(result.error_count) / static_cast<double>(result.sent_count) : 0.0;
+
+	spdlog::info("target {:.0f}/s: sent {:.0f}/s, completed {:.0f}/s, {} errors ({:.3f}%)",
+		target_rate, result.sent_count / seconds, result.completed_count / seconds, result.error_count, error_rate * 100.0);
+
+	const histogram_t& latencies = result.latencies;
+
+	for (const double percentile : { 50.0, 75.0, 90.0, 99.0, 99.9, 99.99 })
+	{
+		spdlog::info("    p{:<6} {:>12.1f} us", percentile, latencies.value_at_percentile(percentile) / 1000.0);
+	}
+
+	spdlog::info("    {:<7} {:>12.1f} us", "max", latencies.max() / 1000.0);
+	spdlog::info("    {:<7} {:>12.1f} us", "mean", latencies.mean() / 1000.0);
+}
+
+std::int32_t main(const std::int32_t argument_count, const char* const* const arguments)
+{
+	try
+	{
+		load_options_t options;
+		std::string hgrm_prefix;
+
+		if (!parse_arguments(argument_count, arguments, options, hgrm_prefix))
+		{
+			print_usage();
+
+			return 1;
+		}
+
+		spdlog::info("loadgen");
+
+		const auto ssl_context = std::make_shared<boost_ssl_context_t>(boost_ssl_context_t::ssl_method_t::tls_client);
+
+		set_up_ssl_context(*ssl_context);
+
+		options.thread_count = std::min(options.thread_count, options.connection_count);
+
+		std::vector<std::unique_ptr<load_worker_t>> workers;
+		std::uint32_t opened_count = 0;
+
+		for (std::uint32_t i = 0; i < options.thread_count; i++)
+		{
+			// the connections are spread as evenly as they divide
+			const std::uint32_t connection_count = options.connection_count / options.thread_count + (i < options.connection_count % options.thread_count);
+
+			workers.push_back(std::make_unique<load_worker_t>(options, ssl_context, connection_count));
+
+			opened_count += workers.back()->connect();
+		}
+
+		spdlog::info("opened {} of {} connections on {} threads", opened_count, options.connection_count, options.thread_count);
+
+		if (opened_count == 0)
+		{
+			return 1;
+		}
+
+		for (std::uint32_t step = 1; step <= options.step_count; step++)
+		{
+			const double target_rate = options.requests_per_second * step / options.step_count;
+
+			std::vector<std::future<step_result_t>> worker_results;
+
+			for (const auto& worker : workers)
+			{
+				worker_results.push_back(worker->run_step(target_rate / options.thread_count, options.step_duration));
+			}
+
+			step_result_t result = { .latencies = histogram_t(highest_latency), .sent_count = 0, .completed_count = 0, .error_count = 0 };
+
+			for (auto& worker_result : worker_results)
+			{
+				result.merge(worker_result.get());
+			}
+
+			report_step(target_rate, options.step_duration, result);
+
+			if (!hgrm_prefix.empty())
+			{
+				std::ofstream stream(fmt::format("{}_{:.0f}.hgrm", hgrm_prefix, target_rate));
+
+				result.latencies.write_percentile_distribution(stream, 1000.0);
+			}
+		}
+
+		for (const auto& worker : workers)
+		{
+			worker->stop();
+		}
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(e.what());
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -2,13 +2,36 @@
 #include "listener.hpp"
 #include <serialisation/serialisation.hpp>
 #include <response/response.hpp>
-#include <endian/endian.hpp>
+#include <frame/frame.hpp>
+#include <memory/pool.hpp>
+#include <metrics/metrics.hpp>
+#include <logging/logging.hpp>
+#include "../dispatch/dispatch.hpp"
 
 #include <schema/request_generated.h>
 
+#include <algorithm>
+
+// set while a request is dispatched on this thread, responses queued from its handler are stamped with it,
+// ones queued later or from another thread carry no stamp and are left out of the end to end latency
+static thread_local const void* dispatching_connection = nullptr;
+static thread_local request::request_id_t dispatching_request_id = 0;
+
+// what a buffer with capacity bytes allocated has to grow by to hold size
+static std::uint64_t growth(const std::uint64_t capacity, const std::uint64_t size)
+{
+	return size > capacity ? size - capacity : 0;
+}
+
 connection_t::~connection_t()
 {
 	socket_->close();
+
+	// responses which were never written and grown receive buffers give their share of the budget back with the connection
+	if (memory_budget_)
+	{
+		memory_budget_->release(in_flight_bytes_.load(std::memory_order_relaxed) + received_bytes_);
+	}
 }
 
 std::uint8_t connection_t::handshake(const socket_t::handshake_type_t type) const
@@ -21,9 +44,18 @@ void connection_t::async_handshake(const socket_t::handshake_type_t type, const
 	socket_->async_handshake(type, handler);
 }
 
-void connection_t::await_request()
+void connection_t::await_request(const request_loop_t request_loop)
 {
-	read_request_header_size();
+	request_loop_ = request_loop;
+
+	if (request_loop == request_loop_t::coroutine)
+	{
+		boost::asio::co_spawn(socket_->executor(), co_read_requests(), boost::asio::detached);
+	}
+	else
+	{
+		read_requests();
+	}
 }
 
 socket_t& connection_t::socket() const
@@ -31,62 +63,232 @@ socket_t& connection_t::socket() const
 	return *socket_;
 }
 
-void connection_t::close_self()
+void connection_t::queue_response(serialisation::frame_t frame)
 {
-	parent_listener_->remove_connection(this);
+	// compressed on the queueing thread, outside the lock
+	if (is_compressing_.load(std::memory_order_acquire))
+	{
+		serialisation::frame_t compressed_frame;
+
+		if (response::construct::compress_response(frame, compression_options_, compressed_frame))
+		{
+			frame = std::move(compressed_frame);
+		}
+	}
+
+	queue_frame(std::move(frame));
+}
+
+#ifndef _WIN32
+void connection_t::queue_response(const request::correlation_id_t correlation_id, std::shared_ptr<const response::file_body_t> body)
+{
+	const std::uint64_t body_size = body->size();
+
+	queue_frame(response::construct::make_response_header_frame(correlation_id, body_size, wire_version_), std::move(body), body_size);
 }
+#endif
 
-void connection_t::read_request_header_size()
+void connection_t::queue_frame(serialisation::frame_t frame, std::shared_ptr<const response::file_body_t> body, const std::uint64_t body_size)
 {
-	auto header_size = std::make_shared<request::request_buffer_size_t>();
+	std::uint8_t should_flush = 0;
+	std::uint8_t should_uncork = 0;
+
+	{
+		const std::lock_guard lock(write_mutex_);
 
-	socket_->async_read(header_size.get(), sizeof(request::request_buffer_size_t),
-		[this, header_size](const std::uint8_t is_valid)
+		if (dispatching_connection == this)
 		{
-			if (is_valid)
+			queued_stamps_.push_back({ .request_id = dispatching_request_id, .received_at = received_at_ });
+		}
+
+		if (body)
+		{
+			queued_bodies_.push_back({ .frame_index = queued_frames_.size(), .body = std::move(body) });
+		}
+
+		// counted under the lock, so the write which takes the frame always releases what was counted for it
+		in_flight_bytes_.fetch_add(frame.size(), std::memory_order_relaxed);
+
+		if (memory_budget_)
+		{
+			memory_budget_->acquire(frame.size());
+		}
+
+		queued_bytes_ += frame.size() + body_size;
+		queued_frames_.push_back(std::move(frame));
+
+		if (write_state_ == write_state_t::idle)
+		{
+			write_state_ = write_state_t::writing;
+
+			should_flush = 1;
+		}
+		else if (write_state_ == write_state_t::corked && queued_bytes_ >= cork_limits_.max_bytes)
+		{
+			write_state_ = write_state_t::writing;
+
+			should_uncork = 1;
+		}
+	}
+
+	if (should_flush)
+	{
+		boost::asio::post(socket_->executor(),
+			[self = shared_from_this()]()
 			{
-				read_request_header(endian::from_little(*header_size));
+				self->flush_responses();
 			}
-			else
+		);
+	}
+	else if (should_uncork)
+	{
+		// the cork timer's handler writes the queue once the wait is cancelled
+		boost::asio::post(socket_->executor(),
+			[self = shared_from_this()]()
 			{
-				spdlog::error("failed to read request header size");
-
-				close_self();
+				self->cork_timer_.cancel();
 			}
+		);
+	}
+}
+
+void connection_t::set_cork_limits(const cork_limits_t& cork_limits)
+{
+	const std::lock_guard lock(write_mutex_);
+
+	cork_limits_ = cork_limits;
+}
+
+void connection_t::set_memory_limits(const memory_limits_t& memory_limits)
+{
+	memory_limits_ = memory_limits;
+}
+
+void connection_t::set_memory_budget(std::shared_ptr<memory_budget_t> memory_budget)
+{
+	memory_budget_ = std::move(memory_budget);
+}
+
+void connection_t::set_compression(const compression::options_t& compression_options)
+{
+	compression_options_ = compression_options;
+}
+
+compression::codec_t connection_t::negotiate_compression(const std::span<const std::uint8_t> offered_codecs, const std::uint32_t dictionary_id)
+{
+	const compression::codec_t codec = compression::negotiate(compression_options_.codec, offered_codecs, dictionary_id);
+
+	is_compressing_.store(codec != compression::codec_t::none, std::memory_order_release);
+
+	return codec;
+}
+
+void connection_t::pause_reading()
+{
+	is_reading_paused_ = 1;
+}
+
+void connection_t::resume_reading()
+{
+	boost::asio::post(socket_->executor(),
+		[self = shared_from_this()]()
+		{
+			self->continue_reading();
 		}
 	);
 }
 
-void connection_t::read_request_header(const request::request_buffer_size_t header_size)
+void connection_t::pause_reading_until_written()
+{
+	{
+		const std::lock_guard lock(write_mutex_);
+
+		// nothing is queued or being written, so there is nothing to wait for
+		if (write_state_ == write_state_t::idle)
+		{
+			return;
+		}
+
+		resume_when_written_ = 1;
+	}
+
+	pause_reading();
+}
+
+std::uint64_t connection_t::queued_bytes()
+{
+	const std::lock_guard lock(write_mutex_);
+
+	return queued_bytes_;
+}
+
+frame::wire_version_t connection_t::wire_version() const
+{
+	return wire_version_;
+}
+
+void connection_t::continue_reading()
+{
+	// resumed more than once, or before the pause took effect
+	if (!is_reading_paused_)
+	{
+		return;
+	}
+
+	is_reading_paused_ = 0;
+
+	if (!handle_received_requests())
+	{
+		close_self();
+
+		return;
+	}
+
+	if (!is_reading_paused_)
+	{
+		await_request(request_loop_);
+	}
+}
+
+void connection_t::close_self()
 {
-	auto header_buffer = std::make_shared<std::vector<std::uint8_t>>(header_size);
+	parent_listener_->remove_connection(this);
+}
 
-	socket_->async_read(header_buffer->data(), header_size,
-		[this, header_buffer, header_size](const std::uint8_t is_valid)
+void connection_t::read_requests()
+{
+	receive_buffer_.reserve();
+
+	charge_received_bytes();
+
+	const std::span<std::uint8_t> writable = receive_buffer_.writable();
+
+	socket_->async_read_some(writable.data(), writable.size(),
+		[this](const std::uint8_t is_valid, const std::uint64_t size)
 		{
 			if (is_valid)
 			{
-				spdlog::info("received request header ({})", header_size);
-
-				if (serialisation::is_valid<RequestHeader>(*header_buffer))
-				{
-					const auto* request_header = serialisation::deserialise<RequestHeader>(*header_buffer);
+				receive_buffer_.commit(size);
 
-					const request::request_id_t request_id = request_header->type();
-					const std::uint64_t request_body_size = request_header->body_size();
+				metrics::count_bytes_in(size);
+				received_at_ = std::chrono::steady_clock::now();
 
-					read_request_body(request_id, request_body_size);
+				if (handle_received_requests())
+				{
+					// a paused loop is restarted by continue_reading
+					if (!is_reading_paused_)
+					{
+						read_requests();
+					}
 				}
 				else
 				{
-					spdlog::error("request header is invalid");
-
 					close_self();
 				}
 			}
 			else
 			{
-				spdlog::error("failed to read request header buffer from socket");
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to read requests from socket");
 
 				close_self();
 			}
@@ -94,77 +296,594 @@ void connection_t::read_request_header(const request::request_buffer_size_t head
 	);
 }
 
-void connection_t::read_request_body(const request::request_id_t request_id, const request::request_buffer_size_t body_size)
+awaitable_t<void> connection_t::co_read_requests()
 {
-	auto body_buffer = std::make_shared<std::vector<std::uint8_t>>(body_size);
+	// close_self drops the listener's reference, this keeps the connection alive until the loop returns
+	const std::shared_ptr<connection_t> self = shared_from_this();
+
+	while (true)
+	{
+		receive_buffer_.reserve();
+
+		charge_received_bytes();
+
+		const std::span<std::uint8_t> writable = receive_buffer_.writable();
 
-	socket_->async_read(body_buffer->data(), body_size,
-		[this, request_id, body_buffer](const std::uint8_t is_valid)
+		std::uint64_t size = 0;
+
+		if (!co_await socket_->co_read_some(writable.data(), writable.size(), size))
 		{
-			if (is_valid)
-			{
-				spdlog::info("received request buffer");
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to read requests from socket");
 
-				handle_request(request_id, body_buffer);
+			break;
+		}
 
-				await_request();
-			}
-			else
+		receive_buffer_.commit(size);
+
+		metrics::count_bytes_in(size);
+		received_at_ = std::chrono::steady_clock::now();
+
+		if (!handle_received_requests())
+		{
+			break;
+		}
+
+		// a paused loop is restarted by continue_reading
+		if (is_reading_paused_)
+		{
+			co_return;
+		}
+	}
+
+	close_self();
+}
+
+// writes the queue straight away, or corks it until it reaches max_bytes or max_delay passes
+void connection_t::flush_responses()
+{
+	std::chrono::microseconds cork_delay(0);
+	std::uint8_t is_idle = 0;
+	std::uint8_t should_resume = 0;
+
+	{
+		const std::lock_guard lock(write_mutex_);
+
+		if (queued_frames_.empty())
+		{
+			write_state_ = write_state_t::idle;
+
+			is_idle = 1;
+			should_resume = resume_when_written_;
+			resume_when_written_ = 0;
+		}
+		else if (cork_limits_.max_delay.count() > 0 && queued_bytes_ < cork_limits_.max_bytes)
+		{
+			write_state_ = write_state_t::corked;
+
+			cork_delay = cork_limits_.max_delay;
+		}
+	}
+
+	if (is_idle)
+	{
+		if (should_resume)
+		{
+			resume_reading();
+		}
+
+		return;
+	}
+
+	if (cork_delay.count() == 0)
+	{
+		write_queued_responses();
+
+		return;
+	}
+
+	cork_timer_.expires_after(cork_delay);
+
+	cork_timer_.async_wait(memory::bind_pool(
+		[self = shared_from_this()](const boost::system::error_code&)
+		{
+			self->write_queued_responses();
+		})
+	);
+}
+
+// every response queued since the last write goes out in a single gather write, unless file bodies have to be sent between them
+void connection_t::write_queued_responses()
+{
+	{
+		const std::lock_guard lock(write_mutex_);
+
+		write_state_ = write_state_t::writing;
+
+		writing_frames_.swap(queued_frames_);
+		writing_stamps_.swap(queued_stamps_);
+		writing_bodies_.swap(queued_bodies_);
+		queued_bytes_ = 0;
+	}
+
+	std::uint64_t write_size = 0;
+
+	for (const serialisation::frame_t& frame : writing_frames_)
+	{
+		write_size += frame.size();
+	}
+
+	writing_frame_bytes_ = write_size;
+
+	const std::uint64_t response_count = writing_frames_.size();
+
+	metrics::record_write_queue_depth(response_count);
+
+#ifndef _WIN32
+	if (!writing_bodies_.empty())
+	{
+		for (const queued_body_t& queued_body : writing_bodies_)
+		{
+			write_size += queued_body.body->size();
+		}
+
+		// the frames and bodies are held until the last of them has been sent, which releases the files
+		boost::asio::co_spawn(socket_->executor(), co_write_queued_responses(), memory::bind_pool(
+			[self = shared_from_this(), response_count, write_size](const std::exception_ptr&, const std::uint8_t is_valid)
 			{
-				spdlog::error("failed to read request buffer from socket");
+				self->writing_frames_.clear();
+				self->writing_bodies_.clear();
 
-				close_self();
-			}
+				self->complete_write(is_valid, response_count, write_size);
+			})
+		);
+
+		return;
+	}
+#endif
+
+	write_buffers_.clear();
+
+	for (const serialisation::frame_t& frame : writing_frames_)
+	{
+		write_buffers_.push_back({ .data = frame.data(), .size = frame.size() });
+	}
+
+	socket_->async_gather_write(write_buffers_,
+		[self = shared_from_this(), response_count, write_size](const std::uint8_t is_valid)
+		{
+			self->complete_write(is_valid, response_count, write_size);
 		}
 	);
+
+	// the gather write has copied the frames, so they can go back to the pool before it completes
+	writing_frames_.clear();
 }
 
-void send_response(const std::shared_ptr<connection_t>& connection, const std::shared_ptr<std::vector<std::uint8_t>>& response_body)
+#ifndef _WIN32
+awaitable_t<std::uint8_t> connection_t::co_write_queued_responses()
 {
-	response::async_send_buffer(connection->socket(), response_body,
-		[connection](const std::uint8_t is_valid)
+	std::uint64_t frame_index = 0;
+
+	for (const queued_body_t& queued_body : writing_bodies_)
+	{
+		write_buffers_.clear();
+
+		// up to and including the frame carrying the body's header
+		for (; frame_index <= queued_body.frame_index; frame_index++)
 		{
-			if (is_valid)
+			write_buffers_.push_back({ .data = writing_frames_[frame_index].data(), .size = writing_frames_[frame_index].size() });
+		}
+
+		if (!co_await socket_->co_gather_write(write_buffers_) || !co_await response::co_send_file_body(*socket_, *queued_body.body))
+		{
+			co_return 0;
+		}
+	}
+
+	write_buffers_.clear();
+
+	for (; frame_index < writing_frames_.size(); frame_index++)
+	{
+		write_buffers_.push_back({ .data = writing_frames_[frame_index].data(), .size = writing_frames_[frame_index].size() });
+	}
+
+	if (!write_buffers_.empty() && !co_await socket_->co_gather_write(write_buffers_))
+	{
+		co_return 0;
+	}
+
+	co_return 1;
+}
+#endif
+
+void connection_t::complete_write(const std::uint8_t is_valid, const std::uint64_t response_count, const std::uint64_t write_size)
+{
+	// the frames are no longer held, whether or not they were sent
+	in_flight_bytes_.fetch_sub(writing_frame_bytes_, std::memory_order_relaxed);
+
+	if (memory_budget_)
+	{
+		memory_budget_->release(writing_frame_bytes_);
+	}
+
+	writing_frame_bytes_ = 0;
+
+	if (!is_valid)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to send responses");
+
+		close_self();
+
+		return;
+	}
+
+	SPDLOG_INFO("successfully sent {} response(s)", response_count);
+
+	metrics::count_bytes_out(write_size);
+
+	const auto sent_at = std::chrono::steady_clock::now();
+
+	for (const request_stamp_t& stamp : writing_stamps_)
+	{
+		metrics::record_end_to_end_latency(stamp.request_id, sent_at - stamp.received_at);
+	}
+
+	writing_stamps_.clear();
+
+	flush_responses();
+
+	// reading paused on this connection's own budget, which may now have room, continue_reading checks again
+	if (is_waiting_for_budget_)
+	{
+		is_waiting_for_budget_ = 0;
+
+		continue_reading();
+	}
+}
+
+// dispatches every complete frame in the receive buffer, a trailing partial frame is left for the next read
+std::uint8_t connection_t::handle_received_requests()
+{
+	while (true)
+	{
+		// a handler paused reading, or too much is waiting to be written, the frames left in the buffer wait for continue_reading
+		if (is_reading_paused_ || pause_if_over_budget())
+		{
+			return 1;
+		}
+
+		frame::parsed_frame_t request_frame = { };
+		std::uint64_t required_size = 0;
+
+		const frame::parse_status_t status = frame::parse<RequestHeader>(receive_buffer_.readable(), request_frame, required_size, memory_limits_.frame);
+
+		if (status == frame::parse_status_t::incomplete)
+		{
+			// the next read grows the buffer to fit the frame, which waits until the budgets have room for it
+			if (pause_if_over_budget(growth(receive_buffer_.capacity(), std::max(required_size, frame::receive_buffer_t::default_size))))
 			{
-				spdlog::info("successfully sent response");
+				return 1;
 			}
-			else
+
+			receive_buffer_.require(required_size);
+
+			return 1;
+		}
+
+		if (status == frame::parse_status_t::invalid)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "request header is invalid");
+
+			return 0;
+		}
+
+		if (status == frame::parse_status_t::too_large)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "request frame is larger than the frame limits");
+
+			metrics::count_oversized_frame();
+
+			return 0;
+		}
+
+		// the client's first frame settles the connection's wire format
+		if (!is_wire_version_known_)
+		{
+			wire_version_ = request_frame.version;
+			is_wire_version_known_ = 1;
+		}
+		else if (request_frame.version != wire_version_)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "request frame changed wire format part way through the connection");
+
+			return 0;
+		}
+
+		// the frame is left in the buffer and parsed again once the budgets have room for its decompressed body
+		if (request_frame.header.compression != compression::codec_t::none
+			&& pause_if_over_budget(growth(decompressed_body_.capacity(), request_frame.header.uncompressed_size)))
+		{
+			return 1;
+		}
+
+		SPDLOG_INFO("received request ({})", request_frame.size);
+
+		std::span<std::uint8_t> body_buffer;
+
+		const std::uint8_t is_decompressed = frame::decompress_body(request_frame, decompressed_body_, body_buffer);
+
+		charge_received_bytes();
+
+		if (!is_decompressed)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to decompress request body");
+
+			return 0;
+		}
+
+		const frame::chunk_t chunk_type = request_frame.header.chunk;
+
+		if (chunk_type > frame::chunk_t::last)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "request chunk type is invalid");
+
+			return 0;
+		}
+
+		receive_buffer_.consume(request_frame.size);
+
+		const request::request_id_t request_id = request_frame.header.type;
+		const request::correlation_id_t correlation_id = request_frame.header.correlation_id;
+
+		if (chunk_type == frame::chunk_t::none)
+		{
+			memory::count_request();
+			metrics::count_request(request_id);
+		}
+
+		dispatching_connection = this;
+		dispatching_request_id = request_id;
+
+		// each chunk of a streamed request is timed as a handler call of its own
+		const auto handle_start = std::chrono::steady_clock::now();
+
+		std::uint8_t is_handled = 0;
+
+		if (chunk_type == frame::chunk_t::none)
+		{
+			is_handled = handle_request(request_id, correlation_id, body_buffer);
+		}
+		else
+		{
+			is_handled = handle_request_chunk(request_id, correlation_id, chunk_type, body_buffer);
+		}
+
+		metrics::record_handler_latency(request_id, std::chrono::steady_clock::now() - handle_start);
+
+		dispatching_connection = nullptr;
+
+		frame::release_scratch(decompressed_body_);
+
+		charge_received_bytes();
+
+		if (!is_handled)
+		{
+			return 0;
+		}
+	}
+}
+
+// a connection over its own budget, or which would go over it by growing what it holds for received frames by growth,
+// is resumed by the write which brings it back under, one held back by the shared budget is resumed by whichever
+// connection's write or consumed frame frees enough of it, a connection with nothing being written never waits on
+// its own budget since no write would resume it
+std::uint8_t connection_t::pause_if_over_budget(const std::uint64_t growth)
+{
+	const std::uint64_t in_flight_bytes = in_flight_bytes_.load(std::memory_order_relaxed);
+
+	if (in_flight_bytes > 0 && in_flight_bytes + received_bytes_ + growth > memory_limits_.max_in_flight_bytes)
+	{
+		metrics::count_budget_pause(0);
+
+		is_waiting_for_budget_ = 1;
+
+		pause_reading();
+
+		return 1;
+	}
+
+	if (!memory_budget_ || !memory_budget_->is_exceeded(growth))
+	{
+		return 0;
+	}
+
+	const std::uint8_t is_waiting = memory_budget_->wait(growth,
+		[connection = weak_from_this()]()
+		{
+			if (const std::shared_ptr<connection_t> self = connection.lock())
 			{
-				spdlog::error("failed to send response");
+				self->resume_reading();
 			}
 		}
 	);
+
+	if (!is_waiting)
+	{
+		return 0;
+	}
+
+	metrics::count_budget_pause(1);
+
+	pause_reading();
+
+	return 1;
+}
+
+// the receive buffer's default size is left out, as every connection holds it whatever its client sends
+void connection_t::charge_received_bytes()
+{
+	const std::uint64_t capacity = receive_buffer_.capacity();
+	const std::uint64_t received_bytes = growth(frame::receive_buffer_t::default_size, capacity) + decompressed_body_.capacity();
+
+	if (memory_budget_)
+	{
+		if (received_bytes > received_bytes_)
+		{
+			memory_budget_->acquire(received_bytes - received_bytes_);
+		}
+		else if (received_bytes < received_bytes_)
+		{
+			memory_budget_->release(received_bytes_ - received_bytes);
+		}
+	}
+
+	received_bytes_ = received_bytes;
+}
+
+// the first chunk of a streamed request opens its stream, and the last one finishes and drops it
+std::uint8_t connection_t::handle_request_chunk(const request::request_id_t request_id, const request::correlation_id_t correlation_id, const frame::chunk_t chunk_type,
+	const std::span<std::uint8_t> chunk)
+{
+	auto stream = request_streams_.find(correlation_id);
+
+	if (stream == request_streams_.end())
+	{
+		if (request_streams_.size() >= memory_limits_.max_open_streams)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "request stream would exceed the open stream limit ({})", memory_limits_.max_open_streams);
+
+			return 0;
+		}
+
+		std::unique_ptr<request_stream_t> opened_stream = open_request_stream(request_id, correlation_id);
+
+		if (!opened_stream)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "request type is not accepted as a stream ({})", request_id);
+
+			return 0;
+		}
+
+		memory::count_request();
+		metrics::count_request(request_id);
+
+		stream = request_streams_.emplace(correlation_id, std::move(opened_stream)).first;
+	}
+
+	if (!stream->second->write(chunk))
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "request stream failed to take a chunk ({})", request_id);
+
+		return 0;
+	}
+
+	if (chunk_type == frame::chunk_t::last)
+	{
+		stream->second->finish();
+
+		request_streams_.erase(stream);
+	}
+
+	return 1;
 }
 
-void handle_valid_test_request(const std::shared_ptr<connection_t>& connection, const Client::TestRequest* const request_body)
+static void handle_test_request(client_connection_t& connection, const request::correlation_id_t correlation_id, const Client::TestRequest* const request_body)
 {
-	spdlog::info("test request key: 0x{:X}", request_body->key());
+	SPDLOG_INFO("test request key: 0x{:X}", request_body->key());
 
 	constexpr std::uint64_t response_key = 0x56789;
 
-	const auto response_body = std::make_shared<std::vector<std::uint8_t>>(response::construct::make_test_response(response_key));
+	const flatbuffers::Vector<std::uint8_t>* const payload = request_body->payload();
+
+	std::span<const std::uint8_t> echoed_payload;
+
+	if (payload != nullptr)
+	{
+		echoed_payload = { payload->data(), payload->size() };
+	}
+
+	connection.queue_response(response::construct::make_test_response(correlation_id, response_key, echoed_payload, connection.wire_version()));
+}
 
-	send_response(connection, response_body);
+static void handle_stats_request(client_connection_t& connection, const request::correlation_id_t correlation_id, const Client::StatsRequest* const)
+{
+	connection.queue_response(response::construct::make_stats_response(correlation_id, metrics::snapshot(), connection.wire_version()));
 }
 
-void client_connection_t::handle_request(const request::request_id_t request_id, const std::shared_ptr<std::vector<std::uint8_t>> body_buffer)
+static void handle_compression_request(client_connection_t& connection, const request::correlation_id_t correlation_id, const Client::CompressionRequest* const request_body)
 {
-	if (request_id == Client::RequestId_Test)
+	const flatbuffers::Vector<std::uint8_t>* const codecs = request_body->codecs();
+
+	std::span<const std::uint8_t> offered_codecs;
+
+	if (codecs != nullptr)
 	{
-		if (serialisation::is_valid<Client::TestRequest>(*body_buffer))
-		{
-			const auto* request_body = serialisation::deserialise<Client::TestRequest>(*body_buffer);
-			const auto shared_this = this->shared_from_this();
+		offered_codecs = { codecs->data(), codecs->size() };
+	}
 
-			handle_valid_test_request(shared_this, request_body);
+	const compression::codec_t codec = connection.negotiate_compression(offered_codecs, request_body->dictionary_id());
+
+	connection.queue_response(response::construct::make_compression_response(correlation_id, codec, connection.wire_version()));
+}
+
+// streams each chunk of an echo request straight back, pausing the client's requests while too much of the echo is queued,
+// so neither end holds more than a window of the body however long it is
+class echo_stream_t final : public request_stream_t
+{
+public:
+	static constexpr std::uint64_t window_size = 4 * frame::default_chunk_size;
+
+	explicit echo_stream_t(client_connection_t& connection, const request::correlation_id_t correlation_id)
+			:	connection_(connection),
+				correlation_id_(correlation_id) { }
+
+	std::uint8_t write(const std::span<const std::uint8_t> chunk) override
+	{
+		if (chunk.empty())
+		{
+			return 1;
 		}
-		else
+
+		connection_.queue_response(response::construct::make_response_chunk(correlation_id_, chunk, frame::chunk_t::partial, connection_.wire_version()));
+
+		if (connection_.queued_bytes() >= window_size)
 		{
-			spdlog::error("failed to verify test request body validity");
+			connection_.pause_reading_until_written();
 		}
+
+		return 1;
 	}
-	else
+
+	void finish() override
 	{
-		spdlog::error("unknown request type");
+		connection_.queue_response(response::construct::make_response_chunk(correlation_id_, { }, frame::chunk_t::last, connection_.wire_version()));
 	}
+
+protected:
+	// the connection owns its streams, so it outlives them
+	client_connection_t& connection_;
+	request::correlation_id_t correlation_id_;
+};
+
+static std::unique_ptr<request_stream_t> open_echo_stream(client_connection_t& connection, const request::correlation_id_t correlation_id)
+{
+	return std::make_unique<echo_stream_t>(connection, correlation_id);
+}
+
+typedef dispatch::table_t<client_connection_t,
+	dispatch::route_t<Client::RequestId_Test, handle_test_request>,
+	dispatch::route_t<Client::RequestId_Stats, handle_stats_request>,
+	dispatch::route_t<Client::RequestId_Compression, handle_compression_request>,
+	dispatch::stream_route_t<Client::RequestId_Echo, open_echo_stream>
+> client_dispatch_table_t;
+
+// an unknown id or a body which fails verification gets no response, so the connection is closed instead
+std::uint8_t client_connection_t::handle_request(const request::request_id_t request_id, const request::correlation_id_t correlation_id, const std::span<std::uint8_t> body_buffer)
+{
+	return client_dispatch_table_t::dispatch(*this, request_id, correlation_id, body_buffer);
+}
+
+std::unique_ptr<request_stream_t> client_connection_t::open_request_stream(const request::request_id_t request_id, const request::correlation_id_t correlation_id)
+{
+	return client_dispatch_table_t::open_stream(*this, request_id, correlation_id);
 }
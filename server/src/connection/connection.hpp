@@ -1,37 +1,212 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
 #include <network/socket.hpp>
 #include <request/request_def.hpp>
+#include <frame/receive_buffer.hpp>
+#include <serialisation/serialisation.hpp>
+#include <compression/compression.hpp>
+#include <frame/frame.hpp>
+#include <response/file_body.hpp>
+#include "../dispatch/request_stream.hpp"
+#include "memory_budget.hpp"
 
 class connection_listener_t;
 
 class connection_t : public std::enable_shared_from_this<connection_t>
 {
 public:
+	// the coroutine loop avoids a std::function and closure per read, the callback loop is kept for comparison
+	enum class request_loop_t : std::uint8_t
+	{
+		callback,
+		coroutine
+	};
+
+	// a queue smaller than max_bytes is held back for up to max_delay so more responses can join its write,
+	// a max_delay of zero writes as soon as the previous write completes
+	struct cork_limits_t
+	{
+		std::uint64_t max_bytes;
+		std::chrono::microseconds max_delay;
+	};
+
+	static constexpr cork_limits_t default_cork_limits = { .max_bytes = 16 * 1024, .max_delay = std::chrono::microseconds(0) };
+
+	// a frame over the frame limits closes the connection, while responses queued and not yet written beyond
+	// max_in_flight_bytes pause reading until enough of them have been, so a client which sends faster than it reads
+	// is held back rather than growing its write queue without bound, the receive buffer's growth for a large frame
+	// and the space its body decompresses into count towards max_in_flight_bytes too, a client which opens more than
+	// max_open_streams streamed requests at once is closed, as each holds its stream's state until its last chunk
+	struct memory_limits_t
+	{
+		frame::limits_t frame;
+		std::uint64_t max_in_flight_bytes;
+		std::uint64_t max_open_streams;
+	};
+
+	static constexpr memory_limits_t default_memory_limits = { .frame = frame::default_limits, .max_in_flight_bytes = 16 * 1024 * 1024, .max_open_streams = 16 };
+
 	explicit connection_t(std::unique_ptr<socket_t> socket, std::shared_ptr<connection_listener_t> parent_listener)
 			:	socket_(std::move(socket)),
-				parent_listener_(std::move(parent_listener)) {}
+				parent_listener_(std::move(parent_listener)),
+				cork_timer_(socket_->executor()) {}
 
 	~connection_t();
 
 	[[nodiscard]] std::uint8_t handshake(socket_t::handshake_type_t type) const;
 	void async_handshake(socket_t::handshake_type_t type, const async_callback_t& handler) const;
 
-	void await_request();
+	void await_request(request_loop_t request_loop = request_loop_t::coroutine);
 
 	socket_t& socket() const;
 
+	// may be called from any thread, queued responses are written in order and never overlap
+	void queue_response(serialisation::frame_t frame);
+
+#ifndef _WIN32
+	// the body is sent from its file straight after the header, without being read into memory where the socket allows
+	void queue_response(request::correlation_id_t correlation_id, std::shared_ptr<const response::file_body_t> body);
+#endif
+
+	void set_cork_limits(const cork_limits_t& cork_limits);
+
+	// set before requests are read
+	void set_memory_limits(const memory_limits_t& memory_limits);
+
+	// counts this connection's unwritten responses and grown receive buffers alongside other connections',
+	// reading pauses while it is exceeded or before growing past it, set before requests are read
+	void set_memory_budget(std::shared_ptr<memory_budget_t> memory_budget);
+
+	// the codec and level offered to clients which ask for compression, set before requests are read
+	void set_compression(const compression::options_t& compression_options);
+
+	// agrees on the configured codec if the client offered it, responses queued from then on are compressed with it
+	compression::codec_t negotiate_compression(std::span<const std::uint8_t> offered_codecs, std::uint32_t dictionary_id);
+
+	// called from a handler or stream on the socket's executor, stops reading and dispatching requests until resume_reading,
+	// so a consumer slower than its client holds the client back through tcp instead of buffering what it sends
+	void pause_reading();
+
+	// may be called from any thread
+	void resume_reading();
+
+	// pauses reading until every queued response has been written, for a stream whose responses are what it waits on
+	void pause_reading_until_written();
+
+	// responses queued and not yet handed to a write
+	[[nodiscard]] std::uint64_t queued_bytes();
+
+	// the format of the client's first frame, which every later frame must share and responses are built in,
+	// settled before any handler runs
+	[[nodiscard]] frame::wire_version_t wire_version() const;
+
 protected:
-	virtual void handle_request(request::request_id_t request_id, std::shared_ptr<std::vector<std::uint8_t>> body_buffer) = 0;
+	enum class write_state_t : std::uint8_t
+	{
+		idle,
+		corked,
+		writing
+	};
+
+	// ties a queued response to the request it answers, for the end to end latency metrics
+	struct request_stamp_t
+	{
+		request::request_id_t request_id;
+		std::chrono::steady_clock::time_point received_at;
+	};
+
+	// sent straight after the frame at frame_index, which carries its header
+	struct queued_body_t
+	{
+		std::uint64_t frame_index;
+		std::shared_ptr<const response::file_body_t> body;
+	};
+
+#ifndef _WIN32
+	// the frames before each body go out in one gather write, then the body is sent from its file or mapping
+	awaitable_t<std::uint8_t> co_write_queued_responses();
+#endif
+
+	// body_buffer points into the receive buffer and is only valid for the duration of the call, returning 0 closes the
+	// connection, for a request which cannot be answered and would otherwise leave its client waiting
+	[[nodiscard]] virtual std::uint8_t handle_request(request::request_id_t request_id, request::correlation_id_t correlation_id, std::span<std::uint8_t> body_buffer) = 0;
+
+	// opens the stream which the chunks of a streamed request are written to, null refuses the request
+	virtual std::unique_ptr<request_stream_t> open_request_stream(request::request_id_t request_id, request::correlation_id_t correlation_id) = 0;
 
 	void close_self();
 
-	void read_request_header_size();
-	void read_request_header(request::request_buffer_size_t header_size);
-	void read_request_body(request::request_id_t request_id, request::request_buffer_size_t body_size);
+	void read_requests();
+	awaitable_t<void> co_read_requests();
+	[[nodiscard]] std::uint8_t handle_received_requests();
+	[[nodiscard]] std::uint8_t pause_if_over_budget(std::uint64_t growth = 0);
+	void charge_received_bytes();
+	[[nodiscard]] std::uint8_t handle_request_chunk(request::request_id_t request_id, request::correlation_id_t correlation_id, frame::chunk_t chunk_type, std::span<std::uint8_t> chunk);
+
+	// dispatches the requests left in the receive buffer when reading paused and restarts the read loop
+	void continue_reading();
+
+	// a body sent after the frame counts towards the cork limit with its size
+	void queue_frame(serialisation::frame_t frame, std::shared_ptr<const response::file_body_t> body = nullptr, std::uint64_t body_size = 0);
+
+	void flush_responses();
+	void write_queued_responses();
+	void complete_write(std::uint8_t is_valid, std::uint64_t response_count, std::uint64_t write_size);
 
 	std::unique_ptr<socket_t> socket_;
 	std::shared_ptr<connection_listener_t> parent_listener_;
+
+	frame::receive_buffer_t receive_buffer_;
+
+	// holds the body of a compressed request while it is handled
+	std::vector<std::uint8_t> decompressed_body_;
+
+	// when the read that completed the requests being handled finished
+	std::chrono::steady_clock::time_point received_at_;
+
+	// only touched on the socket's executor, streamed requests by correlation id until their last chunk arrives
+	std::unordered_map<request::correlation_id_t, std::unique_ptr<request_stream_t>> request_streams_;
+	request_loop_t request_loop_ = request_loop_t::coroutine;
+	std::uint8_t is_reading_paused_ = 0;
+	frame::wire_version_t wire_version_ = frame::wire_version_t::v1;
+	std::uint8_t is_wire_version_known_ = 0;
+
+	memory_limits_t memory_limits_ = default_memory_limits;
+	std::shared_ptr<memory_budget_t> memory_budget_;
+
+	// frame bytes queued or being written, file bodies are left out since they are not held in memory,
+	// added under write_mutex_ and released on the socket's executor once a write completes
+	std::atomic<std::uint64_t> in_flight_bytes_ = 0;
+
+	// what the receive buffer holds beyond its default size and the decompression scratch holds, charged alongside
+	// in_flight_bytes_ and only touched on the socket's executor
+	std::uint64_t received_bytes_ = 0;
+
+	// only touched on the socket's executor
+	boost::asio::steady_timer cork_timer_;
+	std::vector<serialisation::frame_t> writing_frames_;
+	std::vector<socket_buffer_t> write_buffers_;
+	std::vector<request_stamp_t> writing_stamps_;
+	std::vector<queued_body_t> writing_bodies_;
+	std::uint64_t writing_frame_bytes_ = 0;
+	std::uint8_t is_waiting_for_budget_ = 0;
+
+	std::mutex write_mutex_;
+	std::vector<serialisation::frame_t> queued_frames_;
+	std::vector<request_stamp_t> queued_stamps_;
+	std::vector<queued_body_t> queued_bodies_;
+	std::uint64_t queued_bytes_ = 0;
+	write_state_t write_state_ = write_state_t::idle;
+	cork_limits_t cork_limits_ = default_cork_limits;
+	std::uint8_t resume_when_written_ = 0;
+
+	compression::options_t compression_options_ = compression::disabled;
+	std::atomic<std::uint8_t> is_compressing_ = 0;
 };
 
 class client_connection_t final : public connection_t
@@ -41,5 +216,6 @@ public:
 			:	connection_t(std::move(socket), std::move(parent_listener)) {}
 
 protected:
-	void handle_request(request::request_id_t request_id, std::shared_ptr<std::vector<std::uint8_t>> body_buffer) override;
+	[[nodiscard]] std::uint8_t handle_request(request::request_id_t request_id, request::correlation_id_t correlation_id, std::span<std::uint8_t> body_buffer) override;
+	std::unique_ptr<request_stream_t> open_request_stream(request::request_id_t request_id, request::correlation_id_t correlation_id) override;
 };
@@ -1,21 +1,35 @@
 #include "listener.hpp"
 
+#include <metrics/metrics.hpp>
+#include <logging/logging.hpp>
+
 void connection_listener_t::add_connection(std::shared_ptr<connection_t> connection)
 {
+	metrics::count_accepted_connection();
+
+	const auto handshake_start = std::chrono::steady_clock::now();
+
 	connection->async_handshake(socket_t::handshake_type_t::server,
-		[this, connection](const std::uint8_t is_valid)
+		[this, connection, handshake_start](const std::uint8_t is_valid)
 		{
+			metrics::record_handshake(is_valid, std::chrono::steady_clock::now() - handshake_start);
+
 			if (is_valid)
 			{
-				spdlog::info("handshake was successful");
+				SPDLOG_INFO("handshake was successful");
 
 				connections_.push_back(connection);
 
-				connection->await_request();
+				connection->set_cork_limits(cork_limits_);
+				connection->set_memory_limits(memory_limits_);
+				connection->set_memory_budget(memory_budget_);
+				connection->set_compression(compression_options_);
+
+				connection->await_request(request_loop_);
 			}
 			else
 			{
-				spdlog::error("failed to handshake");
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to handshake");
 			}
 		}
 	);
@@ -30,3 +44,28 @@ void connection_listener_t::remove_connection(connection_t* const connection)
 		}
 	);
 }
+
+void connection_listener_t::set_request_loop(const connection_t::request_loop_t request_loop)
+{
+	request_loop_ = request_loop;
+}
+
+void connection_listener_t::set_cork_limits(const connection_t::cork_limits_t& cork_limits)
+{
+	cork_limits_ = cork_limits;
+}
+
+void connection_listener_t::set_memory_limits(const connection_t::memory_limits_t& memory_limits)
+{
+	memory_limits_ = memory_limits;
+}
+
+void connection_listener_t::set_memory_budget(std::shared_ptr<memory_budget_t> memory_budget)
+{
+	memory_budget_ = std::move(memory_budget);
+}
+
+void connection_listener_t::set_compression(const compression::options_t& compression_options)
+{
+	compression_options_ = compression_options;
+}
@@ -1,6 +1,12 @@
 #pragma once
 #include "connection.hpp"
 
+#include <network/plain_socket.hpp>
+#include <network/shm_socket.hpp>
+#include <logging/logging.hpp>
+
+#include <filesystem>
+
 #include <spdlog/spdlog.h>
 
 class connection_listener_t
@@ -14,10 +20,34 @@ public:
 	void add_connection(std::shared_ptr<connection_t> connection);
 	void remove_connection(connection_t* connection);
 
+	void set_request_loop(connection_t::request_loop_t request_loop);
+	void set_cork_limits(const connection_t::cork_limits_t& cork_limits);
+	void set_memory_limits(const connection_t::memory_limits_t& memory_limits);
+
+	// shared with the other listeners given it, so the limit holds across every worker's connections
+	void set_memory_budget(std::shared_ptr<memory_budget_t> memory_budget);
+
+	// see connection_t::set_compression, compression stays off for clients which never ask for it
+	void set_compression(const compression::options_t& compression_options);
+
 protected:
 	std::vector<std::shared_ptr<connection_t>> connections_;
+	connection_t::request_loop_t request_loop_ = connection_t::request_loop_t::coroutine;
+	connection_t::cork_limits_t cork_limits_ = connection_t::default_cork_limits;
+	connection_t::memory_limits_t memory_limits_ = connection_t::default_memory_limits;
+	std::shared_ptr<memory_budget_t> memory_budget_;
+	compression::options_t compression_options_ = compression::disabled;
 };
 
+#ifdef SO_REUSEPORT
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port_t;
+
+// several listeners can bind the same port and the kernel balances connections between them
+constexpr std::uint8_t supports_reuse_port = 1;
+#else
+constexpr std::uint8_t supports_reuse_port = 0;
+#endif
+
 // must be created as a shared ptr
 template <class connection_type_t>
 class boost_connection_listener_t final : public connection_listener_t, public std::enable_shared_from_this<boost_connection_listener_t<connection_type_t>>
@@ -31,19 +61,56 @@ public:
 	typedef boost::asio::ip::tcp::endpoint endpoint_t;
 	typedef boost::asio::ip::tcp::socket asio_socket_t;
 
-	boost_connection_listener_t(std::shared_ptr<asio_context_t> io_context, std::shared_ptr<boost_ssl_context_t> ssl_context, const std::uint16_t port)
+	boost_connection_listener_t(std::shared_ptr<asio_context_t> io_context, std::shared_ptr<boost_ssl_context_t> ssl_context, const std::uint16_t port, const std::uint8_t reuse_port = 0)
 			:	io_context_(std::move(io_context)),
 				ssl_context_(std::move(ssl_context)),
-				acceptor_(std::make_unique<acceptor_t>(*io_context_, endpoint_t(tcp_t::v4(), port))) { }
+				acceptor_(make_acceptor(*io_context_, port, reuse_port)) { }
 
 	void async_wait_for_connection() override;
 
+	// accepted sockets handshake in kernel tls mode, see boost_tcp_socket_t::enable_kernel_tls
+	void enable_kernel_tls();
+
 protected:
+	static std::unique_ptr<acceptor_t> make_acceptor(asio_context_t& io_context, std::uint16_t port, std::uint8_t reuse_port);
+
 	std::shared_ptr<asio_context_t> io_context_;
 	std::shared_ptr<boost_ssl_context_t> ssl_context_;
 	std::unique_ptr<acceptor_t> acceptor_;
+	std::uint8_t is_kernel_tls_ = 0;
 };
 
+template <class connection_type_t>
+std::unique_ptr<typename boost_connection_listener_t<connection_type_t>::acceptor_t> boost_connection_listener_t<connection_type_t>::make_acceptor(asio_context_t& io_context, const std::uint16_t port, const std::uint8_t reuse_port)
+{
+	const endpoint_t endpoint(tcp_t::v4(), port);
+
+	auto acceptor = std::make_unique<acceptor_t>(io_context);
+
+	acceptor->open(endpoint.protocol());
+	acceptor->set_option(typename acceptor_t::reuse_address(true));
+
+#ifdef SO_REUSEPORT
+	if (reuse_port)
+	{
+		acceptor->set_option(reuse_port_t(true));
+	}
+#else
+	(void)reuse_port;
+#endif
+
+	acceptor->bind(endpoint);
+	acceptor->listen();
+
+	return acceptor;
+}
+
+template <class connection_type_t>
+void boost_connection_listener_t<connection_type_t>::enable_kernel_tls()
+{
+	is_kernel_tls_ = 1;
+}
+
 template <class connection_type_t>
 void boost_connection_listener_t<connection_type_t>::async_wait_for_connection()
 {
@@ -57,16 +124,148 @@ void boost_connection_listener_t<connection_type_t>::async_wait_for_connection()
 				const auto remote_endpoint = asio_socket.remote_endpoint();
 				const auto endpoint_address = remote_endpoint.address();
 
-				spdlog::info("accepting connection from {} on port {}", endpoint_address.to_string(), local_endpoint.port());
+				SPDLOG_INFO("accepting connection from {} on port {}", endpoint_address.to_string(), local_endpoint.port());
 
 				auto socket = std::make_unique<boost_tcp_socket_t>(io_context_, std::move(asio_socket), ssl_context_);
+
+				if (is_kernel_tls_)
+				{
+					socket->enable_kernel_tls();
+				}
+				auto connection = std::make_shared<connection_type_t>(std::move(socket), this->shared_from_this());
+
+				add_connection(std::move(connection));
+			}
+			else
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+			}
+
+			async_wait_for_connection();
+		}
+	);
+}
+
+// accepts connections without tls, over tcp or a unix domain socket, must be created as a shared ptr
+// socket_type_t is constructed from the io context and each accepted socket
+template <class connection_type_t, class protocol_t, class socket_type_t = boost_plain_socket_t<protocol_t>>
+class boost_plain_connection_listener_t final : public connection_listener_t, public std::enable_shared_from_this<boost_plain_connection_listener_t<connection_type_t, protocol_t, socket_type_t>>
+{
+	static_assert(std::is_base_of_v<connection_t, connection_type_t>, "connection_type_t must derive from connection_t");
+	static_assert(std::is_base_of_v<socket_t, socket_type_t>, "socket_type_t must derive from socket_t");
+
+public:
+	typedef boost::asio::io_context asio_context_t;
+	typedef typename protocol_t::acceptor acceptor_t;
+	typedef typename protocol_t::endpoint endpoint_t;
+	typedef typename protocol_t::socket asio_socket_t;
+	typedef std::function<void(socket_type_t& socket)> socket_configuration_t;
+
+	// reuse_port only applies to tcp endpoints
+	boost_plain_connection_listener_t(std::shared_ptr<asio_context_t> io_context, const endpoint_t& endpoint, const std::uint8_t reuse_port = 0)
+			:	io_context_(std::move(io_context)),
+				acceptor_(make_acceptor(*io_context_, endpoint, reuse_port)) { }
+
+	void async_wait_for_connection() override;
+
+	// applied to every accepted socket before its handshake, such as a shared memory socket's ring capacity and busy polling
+	void set_socket_configuration(socket_configuration_t configure);
+
+protected:
+	static std::unique_ptr<acceptor_t> make_acceptor(asio_context_t& io_context, const endpoint_t& endpoint, std::uint8_t reuse_port);
+
+	std::shared_ptr<asio_context_t> io_context_;
+	std::unique_ptr<acceptor_t> acceptor_;
+	socket_configuration_t configure_;
+};
+
+template <class connection_type_t>
+using boost_plain_tcp_connection_listener_t = boost_plain_connection_listener_t<connection_type_t, boost::asio::ip::tcp>;
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+template <class connection_type_t>
+using boost_unix_connection_listener_t = boost_plain_connection_listener_t<connection_type_t, boost::asio::local::stream_protocol>;
+#endif
+
+#ifdef __linux__
+// clients connect to the unix domain socket and are then served through shared memory
+template <class connection_type_t>
+using boost_shm_connection_listener_t = boost_plain_connection_listener_t<connection_type_t, boost::asio::local::stream_protocol, boost_shm_socket_t>;
+#endif
+
+template <class connection_type_t, class protocol_t, class socket_type_t>
+std::unique_ptr<typename boost_plain_connection_listener_t<connection_type_t, protocol_t, socket_type_t>::acceptor_t> boost_plain_connection_listener_t<connection_type_t, protocol_t, socket_type_t>::make_acceptor(asio_context_t& io_context, const endpoint_t& endpoint, const std::uint8_t reuse_port)
+{
+	auto acceptor = std::make_unique<acceptor_t>(io_context);
+
+	if constexpr (std::is_same_v<protocol_t, boost::asio::ip::tcp>)
+	{
+		acceptor->open(endpoint.protocol());
+		acceptor->set_option(typename acceptor_t::reuse_address(true));
+
+#ifdef SO_REUSEPORT
+		if (reuse_port)
+		{
+			acceptor->set_option(reuse_port_t(true));
+		}
+#else
+		(void)reuse_port;
+#endif
+	}
+	else
+	{
+		(void)reuse_port;
+
+		// a socket file left behind by an earlier run would make the bind fail
+		std::error_code error_code = { };
+
+		std::filesystem::remove(endpoint.path(), error_code);
+
+		acceptor->open(endpoint.protocol());
+	}
+
+	acceptor->bind(endpoint);
+	acceptor->listen();
+
+	return acceptor;
+}
+
+template <class connection_type_t, class protocol_t, class socket_type_t>
+void boost_plain_connection_listener_t<connection_type_t, protocol_t, socket_type_t>::set_socket_configuration(socket_configuration_t configure)
+{
+	configure_ = std::move(configure);
+}
+
+template <class connection_type_t, class protocol_t, class socket_type_t>
+void boost_plain_connection_listener_t<connection_type_t, protocol_t, socket_type_t>::async_wait_for_connection()
+{
+	acceptor_->async_accept(
+		[this](const boost::system::error_code& error_code, asio_socket_t asio_socket)
+		{
+			if (!error_code)
+			{
+				if constexpr (std::is_same_v<protocol_t, boost::asio::ip::tcp>)
+				{
+					SPDLOG_INFO("accepting plaintext connection from {} on port {}", asio_socket.remote_endpoint().address().to_string(), asio_socket.local_endpoint().port());
+				}
+				else
+				{
+					SPDLOG_INFO("accepting connection on {}", acceptor_->local_endpoint().path());
+				}
+
+				auto socket = std::make_unique<socket_type_t>(io_context_, std::move(asio_socket));
+
+				if (configure_)
+				{
+					configure_(*socket);
+				}
 				auto connection = std::make_shared<connection_type_t>(std::move(socket), this->shared_from_this());
 
 				add_connection(std::move(connection));
 			}
 			else
 			{
-				spdlog::error(error_code.what());
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
 			}
 
 			async_wait_for_connection();
@@ -0,0 +1,79 @@
+#include "memory_budget.hpp"
+
+void memory_budget_t::acquire(const std::uint64_t size)
+{
+	used_bytes_.fetch_add(size, std::memory_order_relaxed);
+}
+
+void memory_budget_t::release(const std::uint64_t size)
+{
+	// sequentially consistent along with wait, which counts itself before checking the usage, so either the waiter sees
+	// this release or this release sees the waiter
+	const std::uint64_t used_bytes = used_bytes_.fetch_sub(size) - size;
+
+	if (used_bytes > max_bytes_ || waiter_count_.load() == 0)
+	{
+		return;
+	}
+
+	std::vector<std::function<void()>> resumes;
+
+	{
+		const std::lock_guard lock(waiter_mutex_);
+
+		// waiters whose size does not fit yet stay registered for a later release
+		std::erase_if(waiters_,
+			[this, used_bytes, &resumes](waiter_t& waiter)
+			{
+				if (used_bytes + waiter.size > max_bytes_)
+				{
+					return false;
+				}
+
+				resumes.push_back(std::move(waiter.resume));
+
+				return true;
+			}
+		);
+
+		waiter_count_ = waiters_.size();
+	}
+
+	for (const std::function<void()>& resume : resumes)
+	{
+		resume();
+	}
+}
+
+std::uint8_t memory_budget_t::is_exceeded(const std::uint64_t size) const
+{
+	return used_bytes_.load(std::memory_order_relaxed) + size > max_bytes_;
+}
+
+std::uint8_t memory_budget_t::wait(const std::uint64_t size, std::function<void()> resume)
+{
+	if (size > max_bytes_)
+	{
+		return 0;
+	}
+
+	const std::lock_guard lock(waiter_mutex_);
+
+	waiter_count_++;
+
+	if (used_bytes_.load() + size <= max_bytes_)
+	{
+		waiter_count_--;
+
+		return 0;
+	}
+
+	waiters_.push_back({ .size = size, .resume = std::move(resume) });
+
+	return 1;
+}
+
+std::uint64_t memory_budget_t::used_bytes() const
+{
+	return used_bytes_.load(std::memory_order_relaxed);
+}
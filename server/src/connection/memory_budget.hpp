@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// bytes held by responses which have been queued and not yet written and by receive buffers grown for large frames,
+// shared by every connection it is given to, connections stop reading requests while it is over its limit, or before
+// growing past it, and are resumed once enough has been written or consumed
+class memory_budget_t
+{
+public:
+	explicit memory_budget_t(const std::uint64_t max_bytes)
+			:	max_bytes_(max_bytes) { }
+
+	// may be called from any thread, sizes are counted whether or not the budget is exceeded, it only holds back reads
+	void acquire(std::uint64_t size);
+	void release(std::uint64_t size);
+
+	// whether size more bytes would take usage over the limit
+	[[nodiscard]] std::uint8_t is_exceeded(std::uint64_t size = 0) const;
+
+	// registers resume to be called once size more bytes fit within the limit, on the thread that released it,
+	// returns 0 without registering it if they already do, or never could since size alone is over the limit
+	[[nodiscard]] std::uint8_t wait(std::uint64_t size, std::function<void()> resume);
+
+	[[nodiscard]] std::uint64_t used_bytes() const;
+
+protected:
+	struct waiter_t
+	{
+		std::uint64_t size;
+		std::function<void()> resume;
+	};
+
+	const std::uint64_t max_bytes_;
+	std::atomic<std::uint64_t> used_bytes_ = 0;
+
+	// lets a release skip the lock while no connection waits, so the workers' writes do not contend for it
+	std::atomic<std::uint64_t> waiter_count_ = 0;
+	std::mutex waiter_mutex_;
+	std::vector<waiter_t> waiters_;
+};
@@ -0,0 +1,205 @@
+#pragma once
+#include <request/request_def.hpp>
+#include <serialisation/serialisation.hpp>
+#include <logging/logging.hpp>
+#include "request_stream.hpp"
+
+#include <schema/request_generated.h>
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+namespace dispatch
+{
+	template <class handler_t>
+	struct handler_traits_t;
+
+	template <class context_t, class body_t>
+	struct handler_traits_t<void(*)(context_t&, request::correlation_id_t, const body_t*)>
+	{
+		typedef context_t context_type;
+		typedef body_t body_type;
+	};
+
+	template <class opener_t>
+	struct opener_traits_t;
+
+	template <class context_t>
+	struct opener_traits_t<std::unique_ptr<request_stream_t>(*)(context_t&, request::correlation_id_t)>
+	{
+		typedef context_t context_type;
+	};
+
+	// binds a request id to a handler, the flatbuffers table of the body is taken from the handler's signature
+	template <Client::RequestId request_id_v, auto handler_v>
+	struct route_t
+	{
+		typedef typename handler_traits_t<decltype(handler_v)>::context_type context_t;
+		typedef typename handler_traits_t<decltype(handler_v)>::body_type body_t;
+
+		static constexpr Client::RequestId request_id = request_id_v;
+
+		static_assert(request_id_v >= Client::RequestId_MIN && request_id_v <= Client::RequestId_MAX, "route request id is not part of Client::RequestId");
+
+		static std::uint8_t invoke(context_t& context, const request::correlation_id_t correlation_id, const std::span<std::uint8_t> body_buffer)
+		{
+			if (!serialisation::is_valid<body_t>(body_buffer))
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to verify request body validity ({})", static_cast<std::uint32_t>(request_id));
+
+				return 0;
+			}
+
+			handler_v(context, correlation_id, serialisation::deserialise<body_t>(body_buffer));
+
+			return 1;
+		}
+
+		// a table can only be verified once all of it has arrived, so its body is never streamed
+		static std::unique_ptr<request_stream_t> open(context_t&, const request::correlation_id_t)
+		{
+			return nullptr;
+		}
+	};
+
+	// binds a request id to a function opening the stream which receives its body, chunk by chunk as it arrives
+	template <Client::RequestId request_id_v, auto opener_v>
+	struct stream_route_t
+	{
+		typedef typename opener_traits_t<decltype(opener_v)>::context_type context_t;
+
+		static constexpr Client::RequestId request_id = request_id_v;
+
+		static_assert(request_id_v >= Client::RequestId_MIN && request_id_v <= Client::RequestId_MAX, "route request id is not part of Client::RequestId");
+
+		// a body sent in a single frame is streamed as one chunk
+		static std::uint8_t invoke(context_t& context, const request::correlation_id_t correlation_id, const std::span<std::uint8_t> body_buffer)
+		{
+			const std::unique_ptr<request_stream_t> stream = opener_v(context, correlation_id);
+
+			if (!stream || !stream->write(body_buffer))
+			{
+				return 0;
+			}
+
+			stream->finish();
+
+			return 1;
+		}
+
+		static std::unique_ptr<request_stream_t> open(context_t& context, const request::correlation_id_t correlation_id)
+		{
+			return opener_v(context, correlation_id);
+		}
+	};
+
+	constexpr std::uint64_t entry_count = static_cast<std::uint64_t>(Client::RequestId_MAX) + 1;
+
+	// the generated enum has no constexpr count, but its array of values carries one in its type
+	constexpr std::uint64_t request_id_count = std::extent_v<std::remove_reference_t<decltype(Client::EnumValuesRequestId())>>;
+
+	template <class context_t>
+	using entry_function_t = std::uint8_t(*)(context_t&, request::correlation_id_t, std::span<std::uint8_t>);
+
+	template <class context_t>
+	using open_function_t = std::unique_ptr<request_stream_t>(*)(context_t&, request::correlation_id_t);
+
+	template <class ...routes_t>
+	constexpr std::uint8_t has_unique_request_ids()
+	{
+		std::array<std::uint8_t, entry_count> is_routed = { };
+
+		for (const Client::RequestId request_id : { routes_t::request_id... })
+		{
+			if (is_routed[request_id])
+			{
+				return 0;
+			}
+
+			is_routed[request_id] = 1;
+		}
+
+		return 1;
+	}
+
+	// ids without a route fall through to reject
+	template <class context_t, class ...routes_t>
+	constexpr std::array<entry_function_t<context_t>, entry_count> make_entries(const entry_function_t<context_t> reject)
+	{
+		std::array<entry_function_t<context_t>, entry_count> entries = { };
+
+		entries.fill(reject);
+
+		((entries[routes_t::request_id] = &routes_t::invoke), ...);
+
+		return entries;
+	}
+
+	template <class context_t, class ...routes_t>
+	constexpr std::array<open_function_t<context_t>, entry_count> make_open_entries(const open_function_t<context_t> refuse)
+	{
+		std::array<open_function_t<context_t>, entry_count> entries = { };
+
+		entries.fill(refuse);
+
+		((entries[routes_t::request_id] = &routes_t::open), ...);
+
+		return entries;
+	}
+
+	// every route is placed in an array indexed by request id, so dispatching is a bounds check and an indirect call
+	template <class context_t, class ...routes_t>
+	class table_t
+	{
+	public:
+		// returns 0 if the request id is unknown or the body fails verification
+		static std::uint8_t dispatch(context_t& context, const request::request_id_t request_id, const request::correlation_id_t correlation_id, const std::span<std::uint8_t> body_buffer)
+		{
+			if (request_id >= entries_.size())
+			{
+				return reject(context, correlation_id, body_buffer);
+			}
+
+			return entries_[request_id](context, correlation_id, body_buffer);
+		}
+
+		// null if the request id is unknown or its route only takes whole bodies
+		static std::unique_ptr<request_stream_t> open_stream(context_t& context, const request::request_id_t request_id, const request::correlation_id_t correlation_id)
+		{
+			if (request_id >= open_entries_.size())
+			{
+				return nullptr;
+			}
+
+			return open_entries_[request_id](context, correlation_id);
+		}
+
+	protected:
+		typedef entry_function_t<context_t> entry_t;
+		typedef open_function_t<context_t> open_entry_t;
+
+		static std::uint8_t reject(context_t&, const request::correlation_id_t, const std::span<std::uint8_t>)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "unknown request type");
+
+			return 0;
+		}
+
+		static std::unique_ptr<request_stream_t> refuse(context_t&, const request::correlation_id_t)
+		{
+			return nullptr;
+		}
+
+		static_assert((std::is_same_v<typename routes_t::context_t, context_t> && ...), "route handlers must take the table's context");
+		static_assert(has_unique_request_ids<routes_t...>(), "request id is routed more than once");
+		static_assert(sizeof...(routes_t) == request_id_count, "every Client::RequestId needs a route");
+
+		static constexpr std::array<entry_t, entry_count> entries_ = make_entries<context_t, routes_t...>(&reject);
+		static constexpr std::array<open_entry_t, entry_count> open_entries_ = make_open_entries<context_t, routes_t...>(&refuse);
+	};
+}
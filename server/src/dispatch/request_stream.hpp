@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+// receives the body of a streamed request a chunk at a time, in order and on the connection's executor,
+// a stream which cannot keep up pauses the connection's reads rather than buffering the body
+class request_stream_t
+{
+public:
+	virtual ~request_stream_t() = default;
+
+	// chunk points into the receive buffer and is only valid for the duration of the call, returning 0 closes the connection
+	[[nodiscard]] virtual std::uint8_t write(std::span<const std::uint8_t> chunk) = 0;
+
+	// the last chunk has been written
+	virtual void finish() = 0;
+};
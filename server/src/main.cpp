@@ -1,41 +1,67 @@
 #include <spdlog/spdlog.h>
 
+#include <logging/logging.hpp>
+
 #include "connection/listener.hpp"
 #include "network/socket.hpp"
+#include "runtime/runtime.hpp"
 
 static void set_up_ssl_context(ssl_context_t& ssl_context)
 {
 	ssl_context.require_peer_verification();
 
+	// tls 1.3 is negotiated with peers that support it for its 1-rtt handshake
+	ssl_context.set_protocol_versions(ssl_context_t::protocol_version_t::tls_1_2, ssl_context_t::protocol_version_t::tls_1_3);
+
 	ssl_context.load_verify_file("certificate_authority.pem");
 	ssl_context.use_certificate("server_certificate.pem", ssl_context_t::crypto_file_format_t::pem);
 	ssl_context.use_private_key("server_private_key.pem", ssl_context_t::crypto_file_format_t::pem);
 
 	ssl_context.use_tmp_dh_file("dhparams.pem");
+
+	// clients reconnect often, so their handshakes resume rather than run in full
+	ssl_context.enable_session_cache(20 * 1024, std::chrono::minutes(10));
+	ssl_context.enable_session_tickets(std::chrono::hours(1));
 }
 
 std::int32_t main()
 {
+	logging::start_async();
+
 	try
 	{
 		spdlog::info("server");
 
-		const auto client_ssl_context = std::make_shared<boost_ssl_context_t>(boost_ssl_context_t::ssl_method_t::tlsv12_server);
+		const auto client_ssl_context = std::make_shared<boost_ssl_context_t>(boost_ssl_context_t::ssl_method_t::tls_server);
 
 		set_up_ssl_context(*client_ssl_context);
 
-		const auto io_context = std::make_shared<boost::asio::io_context>();
-		const auto client_listener = std::make_shared<boost_connection_listener_t<client_connection_t>>(io_context, client_ssl_context, 2457);
+		// bounds what every worker's connections together hold in unwritten responses and grown receive buffers
+		const auto memory_budget = std::make_shared<memory_budget_t>(256 * 1024 * 1024);
 
-		client_listener->async_wait_for_connection();
+		server_runtime_t runtime({ .thread_count = 0, .pin_threads = 0 });
 
-		io_context->run();
+		runtime.run(
+			[&client_ssl_context, &memory_budget](const std::shared_ptr<boost::asio::io_context>& io_context, const std::uint8_t reuse_port) -> std::shared_ptr<connection_listener_t>
+			{
+				auto listener = std::make_shared<boost_connection_listener_t<client_connection_t>>(io_context, client_ssl_context, 2457, reuse_port);
+
+				// only used with clients which ask for it
+				listener->set_compression({ .codec = compression::codec_t::zstd, .level = 3, .min_size = 512 });
+
+				listener->set_memory_budget(memory_budget);
+
+				return listener;
+			}
+		);
 	}
 	catch (const std::exception& e)
 	{
 		spdlog::error(e.what());
 	}
 
+	logging::stop();
+
 	std::system("pause");
 
 	return 0;
@@ -0,0 +1,162 @@
+#include "runtime.hpp"
+
+#include <metrics/metrics.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+server_runtime_t::~server_runtime_t()
+{
+	stop();
+
+	for (worker_t& worker : workers_)
+	{
+		if (worker.thread.joinable())
+		{
+			worker.thread.join();
+		}
+	}
+}
+
+void server_runtime_t::run(const listener_factory_t& listener_factory)
+{
+	const std::uint32_t worker_count = thread_count();
+
+	if (worker_count != options_.thread_count && options_.thread_count > 1)
+	{
+		spdlog::warn("SO_REUSEPORT is unavailable, running a single worker");
+	}
+
+	// every listener is bound before any worker starts, so a bind failure surfaces here
+	workers_.resize(worker_count);
+
+	for (worker_t& worker : workers_)
+	{
+		worker.io_context = std::make_shared<asio_context_t>(1);
+		worker.listener = listener_factory(worker.io_context, supports_reuse_port);
+
+		worker.listener->async_wait_for_connection();
+	}
+
+	if (options_.metrics_interval.count() > 0 && !options_.metrics_path.empty())
+	{
+		metrics_timer_ = std::make_unique<boost::asio::steady_timer>(*workers_.front().io_context);
+
+		schedule_metrics_dump();
+	}
+
+	for (std::uint32_t i = 0; i < worker_count; i++)
+	{
+		worker_t& worker = workers_[i];
+
+		worker.thread = std::thread(&server_runtime_t::run_worker, this, std::ref(worker), i);
+
+		if (options_.pin_threads)
+		{
+			pin_thread(worker.thread, i);
+		}
+	}
+
+	spdlog::info("server runtime started with {} worker(s)", worker_count);
+
+	for (worker_t& worker : workers_)
+	{
+		worker.thread.join();
+	}
+}
+
+void server_runtime_t::stop()
+{
+	for (const worker_t& worker : workers_)
+	{
+		if (worker.io_context)
+		{
+			worker.io_context->stop();
+		}
+	}
+}
+
+std::uint32_t server_runtime_t::thread_count() const
+{
+	// without SO_REUSEPORT only one listener may bind the port
+	if (!supports_reuse_port)
+	{
+		return 1;
+	}
+
+	if (options_.thread_count != 0)
+	{
+		return options_.thread_count;
+	}
+
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void server_runtime_t::run_worker(worker_t& worker, const std::uint32_t worker_index) const
+{
+	try
+	{
+		worker.io_context->run();
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error("worker {} stopped: {}", worker_index, e.what());
+	}
+}
+
+void server_runtime_t::schedule_metrics_dump()
+{
+	metrics_timer_->expires_after(options_.metrics_interval);
+
+	metrics_timer_->async_wait(
+		[this](const boost::system::error_code& error_code)
+		{
+			if (error_code)
+			{
+				return;
+			}
+
+			std::ofstream stream(options_.metrics_path, std::ios::app);
+
+			if (stream)
+			{
+				metrics::write_json(stream, metrics::snapshot());
+			}
+			else
+			{
+				spdlog::error("failed to open {} for the metrics", options_.metrics_path);
+			}
+
+			schedule_metrics_dump();
+		}
+	);
+}
+
+void server_runtime_t::pin_thread(std::thread& thread, const std::uint32_t processor_index)
+{
+	const std::uint32_t processor_count = std::max(std::thread::hardware_concurrency(), 1u);
+	const std::uint32_t processor = processor_index % processor_count;
+
+#if defined(_WIN32)
+	constexpr std::uint32_t mask_bits = sizeof(DWORD_PTR) * 8;
+
+	SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << (processor % mask_bits));
+#elif defined(__linux__)
+	cpu_set_t cpu_set;
+
+	CPU_ZERO(&cpu_set);
+	CPU_SET(processor, &cpu_set);
+
+	pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+#else
+	(void)thread;
+	(void)processor;
+
+	spdlog::warn("thread pinning is not supported on this platform");
+#endif
+}
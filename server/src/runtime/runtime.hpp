@@ -0,0 +1,60 @@
+#pragma once
+#include <connection/listener.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct runtime_options_t
+{
+	// 0 uses the hardware concurrency
+	std::uint32_t thread_count = 0;
+
+	// pins worker n to logical processor n
+	std::uint8_t pin_threads = 0;
+
+	// appends a snapshot of the metrics to metrics_path as a json line every metrics_interval, zero disables it
+	std::string metrics_path;
+	std::chrono::seconds metrics_interval = std::chrono::seconds(0);
+};
+
+// runs an io_context and a listener per worker thread, each worker owns its connections outright
+class server_runtime_t
+{
+public:
+	typedef boost::asio::io_context asio_context_t;
+	typedef std::function<std::shared_ptr<connection_listener_t>(const std::shared_ptr<asio_context_t>& io_context, std::uint8_t reuse_port)> listener_factory_t;
+
+	explicit server_runtime_t(const runtime_options_t& options)
+			:	options_(options) { }
+
+	~server_runtime_t();
+
+	// blocks until every worker has stopped
+	void run(const listener_factory_t& listener_factory);
+	void stop();
+
+	[[nodiscard]] std::uint32_t thread_count() const;
+
+protected:
+	struct worker_t
+	{
+		std::shared_ptr<asio_context_t> io_context;
+		std::shared_ptr<connection_listener_t> listener;
+		std::thread thread;
+	};
+
+	void run_worker(worker_t& worker, std::uint32_t worker_index) const;
+
+	// the dump runs on the first worker, taking a snapshot only briefly holds the metrics registry
+	void schedule_metrics_dump();
+
+	static void pin_thread(std::thread& thread, std::uint32_t processor_index);
+
+	runtime_options_t options_;
+	std::vector<worker_t> workers_;
+	std::unique_ptr<boost::asio::steady_timer> metrics_timer_;
+};
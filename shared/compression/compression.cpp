@@ -0,0 +1,272 @@
+#include "compression.hpp"
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+#include <zdict.h>
+
+#include <algorithm>
+#include <memory>
+
+// zstd's contexts and lz4's high compression state are reused by every call on a thread
+struct thread_contexts_t
+{
+	thread_contexts_t()
+		:	compression_context(ZSTD_createCCtx()),
+			decompression_context(ZSTD_createDCtx()),
+			lz4_state(LZ4_sizeofStateHC()) { }
+
+	~thread_contexts_t()
+	{
+		ZSTD_freeCCtx(compression_context);
+		ZSTD_freeDCtx(decompression_context);
+	}
+
+	thread_contexts_t(const thread_contexts_t&) = delete;
+	thread_contexts_t& operator=(const thread_contexts_t&) = delete;
+
+	ZSTD_CCtx* compression_context;
+	ZSTD_DCtx* decompression_context;
+	std::vector<std::uint8_t> lz4_state;
+};
+
+// digested once when loaded, so each frame only references it
+struct dictionary_t
+{
+	~dictionary_t()
+	{
+		ZSTD_freeCDict(compression_dictionary);
+		ZSTD_freeDDict(decompression_dictionary);
+	}
+
+	ZSTD_CDict* compression_dictionary;
+	ZSTD_DDict* decompression_dictionary;
+	std::uint32_t id;
+};
+
+static std::unique_ptr<dictionary_t> dictionary;
+
+static thread_contexts_t& thread_contexts()
+{
+	static thread_local thread_contexts_t contexts;
+
+	return contexts;
+}
+
+std::uint8_t compression::is_available(const codec_t codec)
+{
+	switch (codec)
+	{
+		case codec_t::none:
+		case codec_t::lz4:
+		case codec_t::zstd:
+			return 1;
+
+		case codec_t::zstd_dictionary:
+			return dictionary != nullptr;
+	}
+
+	return 0;
+}
+
+std::uint8_t compression::compress(const options_t& options, const std::span<const std::uint8_t> input, std::vector<std::uint8_t>& output)
+{
+	// lz4 sizes are ints, the limit keeps every codec well inside them
+	if (input.empty() || input.size() > max_uncompressed_size)
+	{
+		return 0;
+	}
+
+	switch (options.codec)
+	{
+		case codec_t::lz4:
+		{
+			const auto source = reinterpret_cast<const char*>(input.data());
+			const auto source_size = static_cast<std::int32_t>(input.size());
+
+			output.resize(LZ4_compressBound(source_size));
+
+			const auto destination = reinterpret_cast<char*>(output.data());
+			const auto destination_size = static_cast<std::int32_t>(output.size());
+
+			const std::int32_t size = options.level < LZ4HC_CLEVEL_MIN
+				? LZ4_compress_fast(source, destination, source_size, destination_size, 1)
+				: LZ4_compress_HC_extStateHC(thread_contexts().lz4_state.data(), source, destination, source_size, destination_size, std::min(options.level, LZ4HC_CLEVEL_MAX));
+
+			if (size <= 0)
+			{
+				return 0;
+			}
+
+			output.resize(size);
+
+			break;
+		}
+
+		case codec_t::zstd:
+		case codec_t::zstd_dictionary:
+		{
+			if (options.codec == codec_t::zstd_dictionary && !dictionary)
+			{
+				return 0;
+			}
+
+			output.resize(ZSTD_compressBound(input.size()));
+
+			const std::size_t size = options.codec == codec_t::zstd
+				? ZSTD_compressCCtx(thread_contexts().compression_context, output.data(), output.size(), input.data(), input.size(), options.level)
+				: ZSTD_compress_usingCDict(thread_contexts().compression_context, output.data(), output.size(), input.data(), input.size(), dictionary->compression_dictionary);
+
+			if (ZSTD_isError(size))
+			{
+				return 0;
+			}
+
+			output.resize(size);
+
+			break;
+		}
+
+		default:
+			return 0;
+	}
+
+	return output.size() < input.size();
+}
+
+// lz4 cannot expand its input more than 255 fold, a zstd frame records its content size, which compress always writes
+static std::uint8_t is_plausible_size(const compression::codec_t codec, const std::span<const std::uint8_t> input, const std::uint64_t uncompressed_size)
+{
+	constexpr std::uint64_t lz4_max_ratio = 255;
+
+	switch (codec)
+	{
+		case compression::codec_t::lz4:
+			return uncompressed_size <= input.size() * lz4_max_ratio;
+
+		case compression::codec_t::zstd:
+		case compression::codec_t::zstd_dictionary:
+			return ZSTD_getFrameContentSize(input.data(), input.size()) == uncompressed_size;
+
+		default:
+			return 0;
+	}
+}
+
+std::uint8_t compression::decompress(const codec_t codec, const std::span<const std::uint8_t> input, const std::uint64_t uncompressed_size, std::vector<std::uint8_t>& output)
+{
+	// an empty body is never compressed
+	if (input.empty() || uncompressed_size == 0 || uncompressed_size > max_uncompressed_size || input.size() > max_uncompressed_size)
+	{
+		return 0;
+	}
+
+	// the claimed size is checked against what the input could possibly expand to before output is grown to it
+	if (!is_plausible_size(codec, input, uncompressed_size))
+	{
+		return 0;
+	}
+
+	output.resize(uncompressed_size);
+
+	switch (codec)
+	{
+		case codec_t::lz4:
+		{
+			const std::int32_t size = LZ4_decompress_safe(reinterpret_cast<const char*>(input.data()), reinterpret_cast<char*>(output.data()),
+				static_cast<std::int32_t>(input.size()), static_cast<std::int32_t>(output.size()));
+
+			return size >= 0 && static_cast<std::uint64_t>(size) == uncompressed_size;
+		}
+
+		case codec_t::zstd:
+		case codec_t::zstd_dictionary:
+		{
+			if (codec == codec_t::zstd_dictionary && !dictionary)
+			{
+				return 0;
+			}
+
+			const std::size_t size = codec == codec_t::zstd
+				? ZSTD_decompressDCtx(thread_contexts().decompression_context, output.data(), output.size(), input.data(), input.size())
+				: ZSTD_decompress_usingDDict(thread_contexts().decompression_context, output.data(), output.size(), input.data(), input.size(), dictionary->decompression_dictionary);
+
+			return !ZSTD_isError(size) && size == uncompressed_size;
+		}
+
+		default:
+			return 0;
+	}
+}
+
+compression::codec_t compression::negotiate(const codec_t preferred, const std::span<const std::uint8_t> offered_codecs, const std::uint32_t offered_dictionary_id)
+{
+	if (preferred == codec_t::none || !is_available(preferred) || std::ranges::find(offered_codecs, static_cast<std::uint8_t>(preferred)) == offered_codecs.end())
+	{
+		return codec_t::none;
+	}
+
+	// both ends must hold the same dictionary, not merely one each
+	if (preferred == codec_t::zstd_dictionary && offered_dictionary_id != dictionary_id())
+	{
+		return codec_t::none;
+	}
+
+	return preferred;
+}
+
+std::uint8_t compression::load_dictionary(const std::span<const std::uint8_t> dictionary_buffer, const std::int32_t level)
+{
+	const std::uint32_t id = ZSTD_getDictID_fromDict(dictionary_buffer.data(), dictionary_buffer.size());
+
+	// a raw content dictionary has no id, and the id is how the two ends agree they hold the same one
+	if (id == 0)
+	{
+		return 0;
+	}
+
+	auto loaded = std::make_unique<dictionary_t>();
+
+	loaded->compression_dictionary = ZSTD_createCDict(dictionary_buffer.data(), dictionary_buffer.size(), level);
+	loaded->decompression_dictionary = ZSTD_createDDict(dictionary_buffer.data(), dictionary_buffer.size());
+	loaded->id = id;
+
+	if (loaded->compression_dictionary == nullptr || loaded->decompression_dictionary == nullptr)
+	{
+		return 0;
+	}
+
+	dictionary = std::move(loaded);
+
+	return 1;
+}
+
+std::uint32_t compression::dictionary_id()
+{
+	return dictionary ? dictionary->id : 0;
+}
+
+std::vector<std::uint8_t> compression::train_dictionary(const std::vector<std::vector<std::uint8_t>>& samples, const std::uint64_t capacity)
+{
+	std::vector<std::uint8_t> concatenated_samples;
+	std::vector<std::size_t> sample_sizes;
+
+	for (const std::vector<std::uint8_t>& sample : samples)
+	{
+		concatenated_samples.insert(concatenated_samples.end(), sample.begin(), sample.end());
+		sample_sizes.push_back(sample.size());
+	}
+
+	std::vector<std::uint8_t> trained(capacity);
+
+	const std::size_t size = ZDICT_trainFromBuffer(trained.data(), trained.size(), concatenated_samples.data(), sample_sizes.data(), static_cast<std::uint32_t>(sample_sizes.size()));
+
+	if (ZDICT_isError(size))
+	{
+		return { };
+	}
+
+	trained.resize(size);
+
+	return trained;
+}
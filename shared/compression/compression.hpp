@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace compression
+{
+	// carried in each frame header, so a receiver decompresses any frame whatever was negotiated
+	enum class codec_t : std::uint8_t
+	{
+		none,
+		lz4,
+		zstd,
+
+		// zstd with the dictionary both ends loaded
+		zstd_dictionary
+	};
+
+	struct options_t
+	{
+		codec_t codec;
+
+		// lz4 levels below 3 use its fast compressor and higher ones its high compression one, zstd takes its own levels,
+		// the dictionary codec compresses at the level the dictionary was loaded with
+		std::int32_t level;
+
+		// smaller bodies are sent as they are, compressing them costs more than it saves
+		std::uint64_t min_size;
+	};
+
+	static constexpr options_t disabled = { .codec = codec_t::none, .level = 0, .min_size = 0 };
+
+	// a header claiming more is refused rather than decompressed, as is one claiming more than its body could expand to,
+	// so a small frame cannot make the receiver allocate a large one
+	constexpr std::uint64_t max_uncompressed_size = 64 * 1024 * 1024;
+
+	// the dictionary codec needs a dictionary to have been loaded
+	[[nodiscard]] std::uint8_t is_available(codec_t codec);
+
+	// returns 0 if the codec failed or would not make the input smaller, in which case it should be sent uncompressed
+	[[nodiscard]] std::uint8_t compress(const options_t& options, std::span<const std::uint8_t> input, std::vector<std::uint8_t>& output);
+
+	// output is resized to uncompressed_size once the codec has checked the input could hold that much,
+	// returns 0 if input does not decompress to exactly that many bytes
+	[[nodiscard]] std::uint8_t decompress(codec_t codec, std::span<const std::uint8_t> input, std::uint64_t uncompressed_size, std::vector<std::uint8_t>& output);
+
+	// the codec in preferred if the peer offered it and can use it too, otherwise none
+	[[nodiscard]] codec_t negotiate(codec_t preferred, std::span<const std::uint8_t> offered_codecs, std::uint32_t offered_dictionary_id);
+
+	// the dictionary is shared out of band, every client and server loads the same one before opening connections,
+	// returns 0 if it is not a zstd dictionary
+	std::uint8_t load_dictionary(std::span<const std::uint8_t> dictionary, std::int32_t level);
+
+	// zero while no dictionary is loaded
+	[[nodiscard]] std::uint32_t dictionary_id();
+
+	// builds a dictionary of at most capacity bytes from sample bodies, such as ones captured from real traffic,
+	// empty if there were too few samples to train on
+	std::vector<std::uint8_t> train_dictionary(const std::vector<std::vector<std::uint8_t>>& samples, std::uint64_t capacity);
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include "../request/request_def.hpp"
+#include "../serialisation/serialisation.hpp"
+#include "../endian/endian.hpp"
+#include "../compression/compression.hpp"
+#include "header.hpp"
+
+#include <cstring>
+#include <functional>
+#include <span>
+
+namespace frame
+{
+	enum class parse_status_t : std::uint8_t
+	{
+		complete,
+		incomplete,
+		invalid,
+
+		// the header or body is larger than the limits allow, so the frame is refused before space is made for it
+		too_large
+	};
+
+	// sizes are taken off the wire, so without a bound one frame could make the reader allocate whatever it claims,
+	// a compressed body is held to max_body_size once decompressed as well
+	struct limits_t
+	{
+		std::uint64_t max_header_size;
+		std::uint64_t max_body_size;
+	};
+
+	// senders split streamed bodies into chunks of at most this size, so a transfer of any length holds one at a time
+	constexpr std::uint64_t default_chunk_size = 64 * 1024;
+
+	// a request body too large for these is expected to be streamed in chunks instead
+	constexpr limits_t default_limits = { .max_header_size = 64 * 1024, .max_body_size = 16 * default_chunk_size };
+
+	// a server may answer with a whole body it holds, which the client has asked for and so is trusted further
+	constexpr limits_t default_response_limits = { .max_header_size = 64 * 1024, .max_body_size = compression::max_uncompressed_size };
+
+	// fills buffer with the next part of a streamed body and returns how many bytes it wrote, 0 once the body is exhausted
+	typedef std::function<std::uint64_t(std::span<std::uint8_t> buffer)> chunk_source_t;
+
+	// receives each chunk of a streamed body in order, chunk is only valid for the duration of the call,
+	// returning 0 abandons the transfer
+	typedef std::function<std::uint8_t(std::span<const std::uint8_t> chunk)> chunk_sink_t;
+
+	struct parsed_frame_t
+	{
+		header_t header;
+		wire_version_t version;
+		std::span<std::uint8_t> body;
+		std::uint64_t size;
+	};
+
+	// the header and body sizes are checked before the body is waited on, header_end is where the body starts
+	inline parse_status_t parse_body(const std::span<std::uint8_t> buffer, const std::uint64_t header_end, parsed_frame_t& frame, std::uint64_t& required_size,
+		const limits_t& limits)
+	{
+		const header_t& header = frame.header;
+
+		if (header.body_size > limits.max_body_size || (header.compression != compression::codec_t::none && header.uncompressed_size > limits.max_body_size))
+		{
+			return parse_status_t::too_large;
+		}
+
+		if (header.body_size > buffer.size() - header_end)
+		{
+			required_size = header_end + header.body_size;
+
+			return parse_status_t::incomplete;
+		}
+
+		frame.body = buffer.subspan(header_end, header.body_size);
+		frame.size = header_end + header.body_size;
+
+		return parse_status_t::complete;
+	}
+
+	// a v2 header is decoded straight out of the buffer, with no verifier pass
+	inline parse_status_t parse_v2(const std::span<std::uint8_t> buffer, parsed_frame_t& frame, std::uint64_t& required_size, const limits_t& limits)
+	{
+		if (buffer.size() < v2_header_size)
+		{
+			required_size = v2_header_size;
+
+			return parse_status_t::incomplete;
+		}
+
+		if (!decode_v2(buffer.data(), frame.header))
+		{
+			return parse_status_t::invalid;
+		}
+
+		frame.version = wire_version_t::v2;
+
+		return parse_body(buffer, v2_header_size, frame, required_size, limits);
+	}
+
+	// parses the frame at the front of buffer in place, in whichever format it opens with, v1_header_t is the flatbuffers
+	// header a v1 frame carries, an incomplete frame reports how many bytes it needs through required_size, which never
+	// exceeds the limits
+	template <class v1_header_t>
+	parse_status_t parse(const std::span<std::uint8_t> buffer, parsed_frame_t& frame, std::uint64_t& required_size, const limits_t& limits = default_limits)
+	{
+		if (is_v2(buffer))
+		{
+			return parse_v2(buffer, frame, required_size, limits);
+		}
+
+		request::request_buffer_size_t little_endian_header_size = 0;
+
+		if (buffer.size() < sizeof(little_endian_header_size))
+		{
+			required_size = sizeof(little_endian_header_size);
+
+			return parse_status_t::incomplete;
+		}
+
+		std::memcpy(&little_endian_header_size, buffer.data(), sizeof(little_endian_header_size));
+
+		const request::request_buffer_size_t header_size = endian::from_little(little_endian_header_size);
+
+		if (header_size > limits.max_header_size)
+		{
+			return parse_status_t::too_large;
+		}
+
+		if (header_size > buffer.size() - sizeof(little_endian_header_size))
+		{
+			required_size = sizeof(little_endian_header_size) + header_size;
+
+			return parse_status_t::incomplete;
+		}
+
+		const std::span<std::uint8_t> header_buffer = buffer.subspan(sizeof(little_endian_header_size), header_size);
+
+		if (!serialisation::is_valid<v1_header_t>(header_buffer))
+		{
+			return parse_status_t::invalid;
+		}
+
+		frame.header = decode_v1(serialisation::deserialise<v1_header_t>(header_buffer));
+		frame.version = wire_version_t::v1;
+
+		return parse_body(buffer, sizeof(little_endian_header_size) + header_size, frame, required_size, limits);
+	}
+
+	// the header of a frame built here, which is trusted to be well formed, returns where its body starts
+	template <class v1_header_t>
+	std::uint64_t read_header(const std::span<const std::uint8_t> frame, header_t& header, wire_version_t& version)
+	{
+		if (is_v2(frame))
+		{
+			(void)decode_v2(frame.data(), header);
+
+			version = wire_version_t::v2;
+
+			return v2_header_size;
+		}
+
+		request::request_buffer_size_t little_endian_header_size = 0;
+
+		std::memcpy(&little_endian_header_size, frame.data(), sizeof(little_endian_header_size));
+
+		header = decode_v1(serialisation::deserialise<v1_header_t>(frame.data() + sizeof(little_endian_header_size)));
+		version = wire_version_t::v1;
+
+		return sizeof(little_endian_header_size) + endian::from_little(little_endian_header_size);
+	}
+
+	// the body as the handler should see it, a compressed one is decompressed into buffer and body refers to that,
+	// returns 0 if the frame's codec is unknown here or its body does not decompress to the size its header claims
+	inline std::uint8_t decompress_body(const parsed_frame_t& frame, std::vector<std::uint8_t>& buffer, std::span<std::uint8_t>& body)
+	{
+		if (frame.header.compression == compression::codec_t::none)
+		{
+			body = frame.body;
+
+			return 1;
+		}
+
+		if (!compression::decompress(frame.header.compression, frame.body, frame.header.uncompressed_size, buffer))
+		{
+			return 0;
+		}
+
+		body = buffer;
+
+		return 1;
+	}
+
+	// a scratch buffer keeps the capacity of the largest body it ever held, so it is freed once it has grown past a chunk
+	inline void release_scratch(std::vector<std::uint8_t>& buffer)
+	{
+		if (buffer.capacity() > default_chunk_size)
+		{
+			buffer = { };
+		}
+	}
+}
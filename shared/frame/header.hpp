@@ -0,0 +1,135 @@
+#pragma once
+#include "../request/request_def.hpp"
+#include "../compression/compression.hpp"
+#include "../endian/endian.hpp"
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace frame
+{
+	// v1 frames are a little endian header size then a flatbuffers header, v2 frames open with a fixed size header,
+	// a connection is answered in the format its client opened it with
+	enum class wire_version_t : std::uint8_t
+	{
+		v1 = 1,
+		v2 = 2
+	};
+
+	// a body too large to hold in memory is streamed as a run of frames with one correlation id, each partial
+	// frame carries a chunk of it and the last frame carries the final chunk, which may be empty
+	enum class chunk_t : std::uint8_t
+	{
+		none,
+		partial,
+		last
+	};
+
+	// a frame header's fields whichever format it came in, a response's type is always 0
+	struct header_t
+	{
+		request::request_id_t type;
+		chunk_t chunk;
+		compression::codec_t compression;
+		request::correlation_id_t correlation_id;
+		std::uint64_t body_size;
+		std::uint64_t uncompressed_size;
+	};
+
+	// the v2 header as it lies on the wire, every field little endian, flags holds the chunk_t in its low 2 bits
+	// and the rest of flags and reserved are 0, uncompressed_size is 0 unless the body is compressed
+	struct v2_header_t
+	{
+		std::array<std::uint8_t, 3> magic;
+		std::uint8_t version;
+		std::uint8_t flags;
+		std::uint8_t compression;
+		std::uint8_t type;
+		std::uint8_t reserved;
+		std::uint64_t correlation_id;
+		std::uint64_t body_size;
+		std::uint64_t uncompressed_size;
+	};
+
+	static_assert(sizeof(v2_header_t) == 32 && std::is_trivially_copyable_v<v2_header_t>, "v2_header_t must match the wire layout");
+
+	constexpr std::uint64_t v2_header_size = sizeof(v2_header_t);
+	constexpr std::uint8_t v2_chunk_mask = 0x03;
+
+	// a v1 header size would have to be over 4 MiB to start with these bytes, so the formats are told apart by them
+	constexpr std::array<std::uint8_t, 3> v2_magic = { 'S', 'S', 'L' };
+
+	inline std::uint8_t is_v2(const std::span<const std::uint8_t> buffer)
+	{
+		return buffer.size() >= v2_magic.size() && std::memcmp(buffer.data(), v2_magic.data(), v2_magic.size()) == 0;
+	}
+
+	inline std::array<std::uint8_t, v2_header_size> encode_v2(const header_t& header)
+	{
+		const v2_header_t wire_header = {
+			.magic = v2_magic,
+			.version = static_cast<std::uint8_t>(wire_version_t::v2),
+			.flags = static_cast<std::uint8_t>(header.chunk),
+			.compression = static_cast<std::uint8_t>(header.compression),
+			.type = header.type,
+			.reserved = 0,
+			.correlation_id = endian::to_little(header.correlation_id),
+			.body_size = endian::to_little(header.body_size),
+			.uncompressed_size = endian::to_little(header.uncompressed_size)
+		};
+
+		std::array<std::uint8_t, v2_header_size> encoded = { };
+
+		std::memcpy(encoded.data(), &wire_header, sizeof(wire_header));
+
+		return encoded;
+	}
+
+	// data must hold v2_header_size bytes, which are copied out in one go, returns 0 if the version is not 2
+	// or a bit which has no meaning yet is set
+	inline std::uint8_t decode_v2(const std::uint8_t* const data, header_t& header)
+	{
+		v2_header_t wire_header;
+
+		std::memcpy(&wire_header, data, sizeof(wire_header));
+
+		if (wire_header.version != static_cast<std::uint8_t>(wire_version_t::v2) || (wire_header.flags & ~v2_chunk_mask) != 0 || wire_header.reserved != 0)
+		{
+			return 0;
+		}
+
+		header = {
+			.type = wire_header.type,
+			.chunk = static_cast<chunk_t>(wire_header.flags),
+			.compression = static_cast<compression::codec_t>(wire_header.compression),
+			.correlation_id = endian::from_little(wire_header.correlation_id),
+			.body_size = endian::from_little(wire_header.body_size),
+			.uncompressed_size = endian::from_little(wire_header.uncompressed_size)
+		};
+
+		return 1;
+	}
+
+	// the fields of a verified v1 header, the response header has no type
+	template <class v1_header_t>
+	header_t decode_v1(const v1_header_t* const v1_header)
+	{
+		header_t header = {
+			.type = 0,
+			.chunk = static_cast<chunk_t>(v1_header->chunk()),
+			.compression = static_cast<compression::codec_t>(v1_header->compression()),
+			.correlation_id = v1_header->correlation_id(),
+			.body_size = v1_header->body_size(),
+			.uncompressed_size = v1_header->uncompressed_size()
+		};
+
+		if constexpr (requires { v1_header->type(); })
+		{
+			header.type = v1_header->type();
+		}
+
+		return header;
+	}
+}
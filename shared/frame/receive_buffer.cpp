@@ -0,0 +1,65 @@
+#include "receive_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void frame::receive_buffer_t::reserve()
+{
+	if (begin_ == end_)
+	{
+		begin_ = 0;
+		end_ = 0;
+
+		// idle, so release any space that was grown for an oversized frame
+		if (buffer_.size() > default_size)
+		{
+			buffer_.resize(default_size);
+			buffer_.shrink_to_fit();
+		}
+	}
+	else if (begin_ != 0)
+	{
+		std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+
+		end_ -= begin_;
+		begin_ = 0;
+	}
+
+	const std::uint64_t required_size = std::max(required_, default_size);
+
+	if (buffer_.size() < required_size)
+	{
+		buffer_.resize(required_size);
+	}
+}
+
+std::span<std::uint8_t> frame::receive_buffer_t::writable()
+{
+	return { buffer_.data() + end_, buffer_.size() - end_ };
+}
+
+void frame::receive_buffer_t::commit(const std::uint64_t size)
+{
+	end_ += size;
+}
+
+std::span<std::uint8_t> frame::receive_buffer_t::readable()
+{
+	return { buffer_.data() + begin_, end_ - begin_ };
+}
+
+void frame::receive_buffer_t::consume(const std::uint64_t size)
+{
+	begin_ += size;
+	required_ = 0;
+}
+
+void frame::receive_buffer_t::require(const std::uint64_t size)
+{
+	required_ = size;
+}
+
+std::uint64_t frame::receive_buffer_t::capacity() const
+{
+	return buffer_.capacity();
+}
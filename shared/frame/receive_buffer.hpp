@@ -0,0 +1,40 @@
+#pragma once
+#include "../memory/pool.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace frame
+{
+	// a read buffer that frames are parsed out of in place, so pipelined frames cost a single read
+	class receive_buffer_t
+	{
+	public:
+		// sized to hold a full tls record, grown only for frames that do not fit
+		static constexpr std::uint64_t default_size = 16 * 1024;
+
+		// makes room for the next read: compacts a partial frame to the front, grows for an oversized frame
+		// and shrinks back to the default size once everything has been consumed
+		void reserve();
+
+		[[nodiscard]] std::span<std::uint8_t> writable();
+		void commit(std::uint64_t size);
+
+		[[nodiscard]] std::span<std::uint8_t> readable();
+		void consume(std::uint64_t size);
+
+		// the next frame needs size readable bytes before it can be parsed
+		void require(std::uint64_t size);
+
+		// bytes allocated for the buffer, read into or not
+		[[nodiscard]] std::uint64_t capacity() const;
+
+	protected:
+		// drawn from the pool, so connections that come and go reuse each other's buffers
+		std::vector<std::uint8_t, memory::pool_allocator_t<std::uint8_t>> buffer_;
+		std::uint64_t begin_ = 0;
+		std::uint64_t end_ = 0;
+		std::uint64_t required_ = 0;
+	};
+}
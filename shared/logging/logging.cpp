@@ -0,0 +1,80 @@
+#include "logging.hpp"
+
+#include <spdlog/async.h>
+
+static std::atomic<std::uint64_t> suppressed_messages = 0;
+
+void logging::start_async(const options_t& options)
+{
+	spdlog::init_thread_pool(options.queue_size, options.thread_count);
+
+	const std::shared_ptr<spdlog::logger> previous_logger = spdlog::default_logger();
+
+	auto logger = std::make_shared<spdlog::async_logger>(previous_logger->name(), previous_logger->sinks().begin(), previous_logger->sinks().end(),
+		spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+
+	logger->set_level(previous_logger->level());
+
+	spdlog::set_default_logger(std::move(logger));
+}
+
+void logging::stop()
+{
+	const statistics_t dropped = statistics();
+
+	if (dropped.overrun_messages != 0 || dropped.suppressed_messages != 0)
+	{
+		spdlog::warn("dropped {} log messages which overran the queue and suppressed {} from rate limited call sites", dropped.overrun_messages, dropped.suppressed_messages);
+	}
+
+	spdlog::shutdown();
+}
+
+logging::statistics_t logging::statistics()
+{
+	const std::shared_ptr<spdlog::details::thread_pool> thread_pool = spdlog::thread_pool();
+
+	return {
+		.overrun_messages = thread_pool ? thread_pool->overrun_counter() : 0,
+		.suppressed_messages = suppressed_messages.load(std::memory_order_relaxed)
+	};
+}
+
+void logging::count_suppressed()
+{
+	suppressed_messages.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint8_t logging::rate_limit_t::try_acquire()
+{
+	const std::int64_t window = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	std::int64_t current_window = window_.load(std::memory_order_relaxed);
+
+	// whichever thread moves the window on resets the count, a message racing it may land in either window
+	if (current_window != window && window_.compare_exchange_strong(current_window, window, std::memory_order_relaxed))
+	{
+		window_count_.store(0, std::memory_order_relaxed);
+	}
+
+	if (window_count_.fetch_add(1, std::memory_order_relaxed) < messages_per_second_)
+	{
+		return 1;
+	}
+
+	count_suppressed();
+
+	return 0;
+}
+
+std::uint8_t logging::sample_t::try_acquire()
+{
+	if (call_count_.fetch_add(1, std::memory_order_relaxed) % one_in_ == 0)
+	{
+		return 1;
+	}
+
+	count_suppressed();
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// release builds define SPDLOG_ACTIVE_LEVEL as SPDLOG_LEVEL_WARN, so the SPDLOG_INFO and SPDLOG_DEBUG calls
+// on the request path and the macros below at those levels compile to nothing
+
+// logs at most messages_per_second from this call site, the rest are dropped and counted
+#define LOG_RATE_LIMITED(log_level, messages_per_second, ...) \
+	do \
+	{ \
+		if constexpr ((log_level) >= SPDLOG_ACTIVE_LEVEL) \
+		{ \
+			static logging::rate_limit_t call_site_rate_limit(messages_per_second); \
+			\
+			if (call_site_rate_limit.try_acquire()) \
+			{ \
+				SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), static_cast<spdlog::level::level_enum>(log_level), __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+// logs one in every one_in calls from this call site, the rest are dropped and counted
+#define LOG_SAMPLED(log_level, one_in, ...) \
+	do \
+	{ \
+		if constexpr ((log_level) >= SPDLOG_ACTIVE_LEVEL) \
+		{ \
+			static logging::sample_t call_site_sample(one_in); \
+			\
+			if (call_site_sample.try_acquire()) \
+			{ \
+				SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), static_cast<spdlog::level::level_enum>(log_level), __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+namespace logging
+{
+	struct options_t
+	{
+		// messages waiting for the pattern to be applied and written, once full the oldest are overwritten rather than the caller blocking
+		std::uint64_t queue_size;
+		std::uint32_t thread_count;
+	};
+
+	static constexpr options_t default_options = { .queue_size = 8192, .thread_count = 1 };
+
+	struct statistics_t
+	{
+		// overwritten in the queue before the background thread reached them
+		std::uint64_t overrun_messages;
+
+		// turned away by a rate limited or sampled call site
+		std::uint64_t suppressed_messages;
+	};
+
+	// replaces the default logger with one which formats each message's arguments on the calling thread and hands it
+	// to a background thread, which applies the pattern and writes it to the sinks
+	// and writing to the same sinks, call it before any other thread logs
+	void start_async(const options_t& options = default_options);
+
+	// writes out what is still queued and stops the background thread
+	void stop();
+
+	statistics_t statistics();
+
+	void count_suppressed();
+
+	// a fixed one second window per call site, may be used from any thread
+	class rate_limit_t
+	{
+	public:
+		explicit rate_limit_t(const std::uint32_t messages_per_second)
+				:	messages_per_second_(messages_per_second) { }
+
+		[[nodiscard]] std::uint8_t try_acquire();
+
+	protected:
+		std::uint32_t messages_per_second_;
+		std::atomic<std::int64_t> window_ = -1;
+		std::atomic<std::uint32_t> window_count_ = 0;
+	};
+
+	class sample_t
+	{
+	public:
+		explicit sample_t(const std::uint32_t one_in)
+				:	one_in_(one_in == 0 ? 1 : one_in) { }
+
+		[[nodiscard]] std::uint8_t try_acquire();
+
+	protected:
+		std::uint32_t one_in_;
+		std::atomic<std::uint64_t> call_count_ = 0;
+	};
+}
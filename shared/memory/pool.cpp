@@ -0,0 +1,230 @@
+#include "pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <vector>
+
+static constexpr std::uint64_t smallest_class_size = 64;
+static constexpr std::uint64_t largest_class_size = 64 * 1024;
+static constexpr std::uint64_t class_count = std::countr_zero(largest_class_size) - std::countr_zero(smallest_class_size) + 1;
+
+// bounds how much memory each size class of a thread may hold on to
+static constexpr std::uint64_t class_retained_bytes = 1024 * 1024;
+
+struct free_block_t
+{
+	free_block_t* next;
+};
+
+struct free_list_t
+{
+	free_block_t* head = nullptr;
+	std::uint64_t count = 0;
+};
+
+class thread_pool_t;
+
+static std::mutex registry_mutex;
+static std::vector<thread_pool_t*> registry;
+
+// counters retired by threads that have exited
+static memory::statistics_t retired_statistics = { };
+
+class thread_pool_t
+{
+public:
+	thread_pool_t()
+	{
+		const std::lock_guard lock(registry_mutex);
+
+		registry.push_back(this);
+	}
+
+	~thread_pool_t()
+	{
+		{
+			const std::lock_guard lock(registry_mutex);
+
+			const memory::statistics_t thread_statistics = statistics();
+
+			retired_statistics.pooled_allocations += thread_statistics.pooled_allocations;
+			retired_statistics.heap_allocations += thread_statistics.heap_allocations;
+			retired_statistics.requests += thread_statistics.requests;
+
+			std::erase(registry, this);
+		}
+
+		for (free_list_t& free_list : free_lists_)
+		{
+			while (free_list.head != nullptr)
+			{
+				free_block_t* const block = free_list.head;
+
+				free_list.head = block->next;
+
+				::operator delete(block);
+			}
+		}
+
+		is_alive_ = 0;
+	}
+
+	void* allocate(const std::uint64_t size)
+	{
+		if (size > largest_class_size)
+		{
+			heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+
+			return ::operator new(size);
+		}
+
+		const std::uint64_t class_index = size_class(size);
+		free_list_t& free_list = free_lists_[class_index];
+
+		if (free_list.head != nullptr)
+		{
+			free_block_t* const block = free_list.head;
+
+			free_list.head = block->next;
+			free_list.count--;
+
+			pooled_allocations_.fetch_add(1, std::memory_order_relaxed);
+
+			return block;
+		}
+
+		heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+
+		return ::operator new(class_size(class_index));
+	}
+
+	void deallocate(void* const block, const std::uint64_t size)
+	{
+		if (size > largest_class_size)
+		{
+			::operator delete(block);
+
+			return;
+		}
+
+		const std::uint64_t class_index = size_class(size);
+		free_list_t& free_list = free_lists_[class_index];
+
+		if (free_list.count * class_size(class_index) >= class_retained_bytes)
+		{
+			::operator delete(block);
+
+			return;
+		}
+
+		free_list.head = new (block) free_block_t { .next = free_list.head };
+		free_list.count++;
+	}
+
+	void count_request()
+	{
+		requests_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] memory::statistics_t statistics() const
+	{
+		return {
+			.pooled_allocations = pooled_allocations_.load(std::memory_order_relaxed),
+			.heap_allocations = heap_allocations_.load(std::memory_order_relaxed),
+			.requests = requests_.load(std::memory_order_relaxed)
+		};
+	}
+
+	// blocks freed during thread teardown, after the pool is gone, go back to the heap
+	static thread_local std::uint8_t is_alive_;
+
+protected:
+	static std::uint64_t size_class(const std::uint64_t size)
+	{
+		const std::uint64_t rounded_size = std::bit_ceil(std::max(size, smallest_class_size));
+
+		return std::countr_zero(rounded_size) - std::countr_zero(smallest_class_size);
+	}
+
+	static std::uint64_t class_size(const std::uint64_t class_index)
+	{
+		return smallest_class_size << class_index;
+	}
+
+	std::array<free_list_t, class_count> free_lists_ = { };
+
+	// only written by the owning thread, read relaxed when statistics are aggregated
+	std::atomic<std::uint64_t> pooled_allocations_ = 0;
+	std::atomic<std::uint64_t> heap_allocations_ = 0;
+	std::atomic<std::uint64_t> requests_ = 0;
+};
+
+thread_local std::uint8_t thread_pool_t::is_alive_ = 1;
+
+static thread_pool_t& current_thread_pool()
+{
+	static thread_local thread_pool_t thread_pool;
+
+	return thread_pool;
+}
+
+void* memory::allocate(const std::uint64_t size)
+{
+	if (!thread_pool_t::is_alive_)
+	{
+		return ::operator new(size);
+	}
+
+	return current_thread_pool().allocate(size);
+}
+
+void memory::deallocate(void* const block, const std::uint64_t size)
+{
+	if (block == nullptr)
+	{
+		return;
+	}
+
+	if (!thread_pool_t::is_alive_)
+	{
+		::operator delete(block);
+
+		return;
+	}
+
+	current_thread_pool().deallocate(block, size);
+}
+
+void memory::count_request()
+{
+	current_thread_pool().count_request();
+}
+
+memory::statistics_t memory::statistics()
+{
+	const std::lock_guard lock(registry_mutex);
+
+	statistics_t total_statistics = retired_statistics;
+
+	for (const thread_pool_t* const thread_pool : registry)
+	{
+		const statistics_t thread_statistics = thread_pool->statistics();
+
+		total_statistics.pooled_allocations += thread_statistics.pooled_allocations;
+		total_statistics.heap_allocations += thread_statistics.heap_allocations;
+		total_statistics.requests += thread_statistics.requests;
+	}
+
+	return total_statistics;
+}
+
+memory::frame_allocator_t& memory::frame_allocator()
+{
+	static frame_allocator_t allocator;
+
+	return allocator;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <flatbuffers/flatbuffers.h>
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace memory
+{
+	struct statistics_t
+	{
+		std::uint64_t pooled_allocations;
+		std::uint64_t heap_allocations;
+		std::uint64_t requests;
+	};
+
+	// every thread owns a slab of free lists split into power of two size classes, so allocating
+	// and freeing never takes a lock, blocks larger than the biggest class go straight to the heap
+	void* allocate(std::uint64_t size);
+	void deallocate(void* block, std::uint64_t size);
+
+	// lets callers relate the allocation counters to how many requests were served
+	void count_request();
+
+	// summed over every thread that has used the pool
+	statistics_t statistics();
+
+	template <class t>
+	class pool_allocator_t
+	{
+	public:
+		typedef t value_type;
+
+		pool_allocator_t() noexcept = default;
+
+		template <class other_t>
+		pool_allocator_t(const pool_allocator_t<other_t>&) noexcept { }
+
+		t* allocate(const std::size_t count)
+		{
+			return static_cast<t*>(memory::allocate(count * sizeof(t)));
+		}
+
+		void deallocate(t* const block, const std::size_t count) noexcept
+		{
+			memory::deallocate(block, count * sizeof(t));
+		}
+
+		template <class other_t>
+		bool operator==(const pool_allocator_t<other_t>&) const noexcept
+		{
+			return true;
+		}
+	};
+
+	// backs FlatBufferBuilder so a frame's buffer returns to the pool when the frame is destroyed
+	class frame_allocator_t final : public flatbuffers::Allocator
+	{
+	public:
+		std::uint8_t* allocate(const std::size_t size) override
+		{
+			return static_cast<std::uint8_t*>(memory::allocate(size));
+		}
+
+		void deallocate(std::uint8_t* const block, const std::size_t size) override
+		{
+			memory::deallocate(block, size);
+		}
+	};
+
+	frame_allocator_t& frame_allocator();
+
+	// exposes the pool as the asio associated allocator, so the operation storage for the handler is pooled
+	template <class handler_t>
+	class pooled_handler_t
+	{
+	public:
+		typedef pool_allocator_t<void> allocator_type;
+
+		explicit pooled_handler_t(handler_t handler)
+				:	handler_(std::move(handler)) { }
+
+		allocator_type get_allocator() const noexcept
+		{
+			return { };
+		}
+
+		template <class ...arguments_t>
+		void operator()(arguments_t&&... arguments)
+		{
+			handler_(std::forward<arguments_t>(arguments)...);
+		}
+
+	protected:
+		handler_t handler_;
+	};
+
+	template <class handler_t>
+	pooled_handler_t<std::decay_t<handler_t>> bind_pool(handler_t&& handler)
+	{
+		return pooled_handler_t<std::decay_t<handler_t>>(std::forward<handler_t>(handler));
+	}
+
+	template <class t, class ...arguments_t>
+	std::shared_ptr<t> make_shared(arguments_t&&... arguments)
+	{
+		return std::allocate_shared<t>(pool_allocator_t<t>(), std::forward<arguments_t>(arguments)...);
+	}
+}
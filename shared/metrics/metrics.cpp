@@ -0,0 +1,326 @@
+#include "metrics.hpp"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+static constexpr std::uint64_t sub_bucket_bits = 2;
+static constexpr std::uint64_t linear_bucket_count = 1ull << (sub_bucket_bits + 1);
+
+std::uint64_t metrics::bucket_index(const std::uint64_t value)
+{
+	if (value < linear_bucket_count)
+	{
+		return value;
+	}
+
+	const std::uint64_t exponent = std::bit_width(value) - 1;
+	const std::uint64_t sub_bucket = (value >> (exponent - sub_bucket_bits)) & ((1ull << sub_bucket_bits) - 1);
+
+	return linear_bucket_count + ((exponent - sub_bucket_bits - 1) << sub_bucket_bits) + sub_bucket;
+}
+
+std::uint64_t metrics::bucket_upper_bound(const std::uint64_t index)
+{
+	if (index < linear_bucket_count)
+	{
+		return index;
+	}
+
+	const std::uint64_t exponent = ((index - linear_bucket_count) >> sub_bucket_bits) + sub_bucket_bits + 1;
+	const std::uint64_t sub_bucket = (index - linear_bucket_count) & ((1ull << sub_bucket_bits) - 1);
+	const std::uint64_t width = 1ull << (exponent - sub_bucket_bits);
+
+	return (((1ull << sub_bucket_bits) + sub_bucket) << (exponent - sub_bucket_bits)) + (width - 1);
+}
+
+void metrics::histogram_snapshot_t::merge(const histogram_snapshot_t& other)
+{
+	for (std::uint64_t i = 0; i < histogram_bucket_count; i++)
+	{
+		counts[i] += other.counts[i];
+	}
+
+	total_count += other.total_count;
+	sum += other.sum;
+	max = std::max(max, other.max);
+}
+
+std::uint64_t metrics::histogram_snapshot_t::value_at_percentile(const double percentile) const
+{
+	if (total_count == 0)
+	{
+		return 0;
+	}
+
+	const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+	const std::uint64_t count_at_percentile = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(total_count))), 1);
+
+	std::uint64_t cumulative_count = 0;
+
+	for (std::uint64_t i = 0; i < histogram_bucket_count; i++)
+	{
+		cumulative_count += counts[i];
+
+		if (cumulative_count >= count_at_percentile)
+		{
+			return std::min(bucket_upper_bound(i), max);
+		}
+	}
+
+	return max;
+}
+
+// a counter written only by its owning thread, so an increment is a plain load and store rather than a locked
+// read-modify-write, other threads only ever read it
+class thread_counter_t
+{
+public:
+	void add(const std::uint64_t amount)
+	{
+		value_.store(value_.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	void raise_to(const std::uint64_t value)
+	{
+		if (value > value_.load(std::memory_order_relaxed))
+		{
+			value_.store(value, std::memory_order_relaxed);
+		}
+	}
+
+	[[nodiscard]] std::uint64_t load() const
+	{
+		return value_.load(std::memory_order_relaxed);
+	}
+
+protected:
+	std::atomic<std::uint64_t> value_ = 0;
+};
+
+class histogram_counters_t
+{
+public:
+	void record(const std::uint64_t value)
+	{
+		counts_[metrics::bucket_index(value)].add(1);
+
+		total_count_.add(1);
+		sum_.add(value);
+		max_.raise_to(value);
+	}
+
+	void add_to(metrics::histogram_snapshot_t& snapshot) const
+	{
+		for (std::uint64_t i = 0; i < metrics::histogram_bucket_count; i++)
+		{
+			snapshot.counts[i] += counts_[i].load();
+		}
+
+		snapshot.total_count += total_count_.load();
+		snapshot.sum += sum_.load();
+		snapshot.max = std::max(snapshot.max, max_.load());
+	}
+
+protected:
+	std::array<thread_counter_t, metrics::histogram_bucket_count> counts_ = { };
+	thread_counter_t total_count_;
+	thread_counter_t sum_;
+	thread_counter_t max_;
+};
+
+struct request_type_counters_t
+{
+	thread_counter_t count;
+	histogram_counters_t handler_latency_ns;
+	histogram_counters_t end_to_end_latency_ns;
+};
+
+class thread_metrics_t;
+
+static std::mutex registry_mutex;
+static std::vector<thread_metrics_t*> registry;
+
+// counters retired by threads that have exited
+static metrics::snapshot_t retired_snapshot = { };
+
+class thread_metrics_t
+{
+public:
+	thread_metrics_t()
+	{
+		const std::lock_guard lock(registry_mutex);
+
+		registry.push_back(this);
+	}
+
+	~thread_metrics_t()
+	{
+		const std::lock_guard lock(registry_mutex);
+
+		add_to(retired_snapshot);
+
+		std::erase(registry, this);
+	}
+
+	void add_to(metrics::snapshot_t& snapshot) const
+	{
+		snapshot.accepted_connections += accepted_connections.load();
+		snapshot.handshake_successes += handshake_successes.load();
+		snapshot.handshake_failures += handshake_failures.load();
+		handshake_latency_ns.add_to(snapshot.handshake_latency_ns);
+
+		snapshot.bytes_in += bytes_in.load();
+		snapshot.bytes_out += bytes_out.load();
+
+		for (std::uint64_t i = 0; i < metrics::request_type_count; i++)
+		{
+			snapshot.request_types[i].count += request_types[i].count.load();
+			request_types[i].handler_latency_ns.add_to(snapshot.request_types[i].handler_latency_ns);
+			request_types[i].end_to_end_latency_ns.add_to(snapshot.request_types[i].end_to_end_latency_ns);
+		}
+
+		write_queue_depth.add_to(snapshot.write_queue_depth);
+
+		snapshot.oversized_frames += oversized_frames.load();
+		snapshot.connection_budget_pauses += connection_budget_pauses.load();
+		snapshot.global_budget_pauses += global_budget_pauses.load();
+	}
+
+	thread_counter_t accepted_connections;
+	thread_counter_t handshake_successes;
+	thread_counter_t handshake_failures;
+	histogram_counters_t handshake_latency_ns;
+
+	thread_counter_t bytes_in;
+	thread_counter_t bytes_out;
+
+	std::array<request_type_counters_t, metrics::request_type_count> request_types;
+
+	histogram_counters_t write_queue_depth;
+
+	thread_counter_t oversized_frames;
+	thread_counter_t connection_budget_pauses;
+	thread_counter_t global_budget_pauses;
+};
+
+static thread_metrics_t& current_thread_metrics()
+{
+	static thread_local thread_metrics_t thread_metrics;
+
+	return thread_metrics;
+}
+
+static request_type_counters_t& request_type(const request::request_id_t request_id)
+{
+	return current_thread_metrics().request_types[std::min<std::uint64_t>(request_id, metrics::request_type_count - 1)];
+}
+
+void metrics::count_accepted_connection()
+{
+	current_thread_metrics().accepted_connections.add(1);
+}
+
+void metrics::record_handshake(const std::uint8_t is_valid, const std::chrono::nanoseconds duration)
+{
+	thread_metrics_t& thread_metrics = current_thread_metrics();
+
+	(is_valid ? thread_metrics.handshake_successes : thread_metrics.handshake_failures).add(1);
+
+	thread_metrics.handshake_latency_ns.record(duration.count());
+}
+
+void metrics::count_bytes_in(const std::uint64_t size)
+{
+	current_thread_metrics().bytes_in.add(size);
+}
+
+void metrics::count_bytes_out(const std::uint64_t size)
+{
+	current_thread_metrics().bytes_out.add(size);
+}
+
+void metrics::count_request(const request::request_id_t request_id)
+{
+	request_type(request_id).count.add(1);
+}
+
+void metrics::record_handler_latency(const request::request_id_t request_id, const std::chrono::nanoseconds duration)
+{
+	request_type(request_id).handler_latency_ns.record(duration.count());
+}
+
+void metrics::record_end_to_end_latency(const request::request_id_t request_id, const std::chrono::nanoseconds duration)
+{
+	request_type(request_id).end_to_end_latency_ns.record(duration.count());
+}
+
+void metrics::record_write_queue_depth(const std::uint64_t depth)
+{
+	current_thread_metrics().write_queue_depth.record(depth);
+}
+
+void metrics::count_oversized_frame()
+{
+	current_thread_metrics().oversized_frames.add(1);
+}
+
+void metrics::count_budget_pause(const std::uint8_t is_global)
+{
+	thread_metrics_t& thread_metrics = current_thread_metrics();
+
+	(is_global ? thread_metrics.global_budget_pauses : thread_metrics.connection_budget_pauses).add(1);
+}
+
+metrics::snapshot_t metrics::snapshot()
+{
+	const std::lock_guard lock(registry_mutex);
+
+	snapshot_t total_snapshot = retired_snapshot;
+
+	for (const thread_metrics_t* const thread_metrics : registry)
+	{
+		thread_metrics->add_to(total_snapshot);
+	}
+
+	return total_snapshot;
+}
+
+static std::string histogram_json(const metrics::histogram_snapshot_t& histogram)
+{
+	return fmt::format(R"({{"count":{},"sum":{},"max":{},"p50":{},"p99":{},"p999":{}}})",
+		histogram.total_count, histogram.sum, histogram.max, histogram.value_at_percentile(50.0), histogram.value_at_percentile(99.0), histogram.value_at_percentile(99.9));
+}
+
+void metrics::write_json(std::ostream& stream, const snapshot_t& snapshot)
+{
+	const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+
+	std::string request_types;
+
+	for (std::uint64_t i = 0; i < request_type_count; i++)
+	{
+		const request_type_snapshot_t& request_type_snapshot = snapshot.request_types[i];
+
+		if (request_type_snapshot.count == 0)
+		{
+			continue;
+		}
+
+		// the final slot gathers the unknown ids
+		const std::string name = i + 1 < request_type_count ? Client::EnumNameRequestId(static_cast<Client::RequestId>(i)) : "unknown";
+
+		request_types += fmt::format(R"({}"{}":{{"count":{},"handler_latency_ns":{},"end_to_end_latency_ns":{}}})",
+			request_types.empty() ? "" : ",", name, request_type_snapshot.count, histogram_json(request_type_snapshot.handler_latency_ns), histogram_json(request_type_snapshot.end_to_end_latency_ns));
+	}
+
+	stream << fmt::format(R"({{"timestamp":{},"accepted_connections":{},"handshake_successes":{},"handshake_failures":{},"handshake_latency_ns":{},"bytes_in":{},"bytes_out":{},"request_types":{{{}}},"write_queue_depth":{},"oversized_frames":{},"connection_budget_pauses":{},"global_budget_pauses":{}}})",
+		timestamp.count(), snapshot.accepted_connections, snapshot.handshake_successes, snapshot.handshake_failures, histogram_json(snapshot.handshake_latency_ns),
+		snapshot.bytes_in, snapshot.bytes_out, request_types, histogram_json(snapshot.write_queue_depth), snapshot.oversized_frames, snapshot.connection_budget_pauses,
+		snapshot.global_budget_pauses) << '\n';
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "../request/request_def.hpp"
+
+#include <schema/request_generated.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace metrics
+{
+	// ids past the last known request id are counted together in the final slot
+	constexpr std::uint64_t request_type_count = static_cast<std::uint64_t>(Client::RequestId_MAX) + 2;
+
+	// log linear buckets: values below 8 have their own bucket, every power of two above is split into 4,
+	// so a bucket's upper bound is within 25% of any value in it
+	constexpr std::uint64_t histogram_bucket_count = 252;
+
+	[[nodiscard]] std::uint64_t bucket_index(std::uint64_t value);
+	[[nodiscard]] std::uint64_t bucket_upper_bound(std::uint64_t index);
+
+	struct histogram_snapshot_t
+	{
+		std::array<std::uint64_t, histogram_bucket_count> counts;
+		std::uint64_t total_count;
+		std::uint64_t sum;
+		std::uint64_t max;
+
+		void merge(const histogram_snapshot_t& other);
+
+		// the upper bound of the bucket holding the percentile, never above the largest value recorded
+		[[nodiscard]] std::uint64_t value_at_percentile(double percentile) const;
+	};
+
+	struct request_type_snapshot_t
+	{
+		std::uint64_t count;
+		histogram_snapshot_t handler_latency_ns;
+		histogram_snapshot_t end_to_end_latency_ns;
+	};
+
+	struct snapshot_t
+	{
+		std::uint64_t accepted_connections;
+		std::uint64_t handshake_successes;
+		std::uint64_t handshake_failures;
+		histogram_snapshot_t handshake_latency_ns;
+
+		std::uint64_t bytes_in;
+		std::uint64_t bytes_out;
+
+		std::array<request_type_snapshot_t, request_type_count> request_types;
+
+		// responses waiting in a connection's queue each time it starts a write
+		histogram_snapshot_t write_queue_depth;
+
+		// frames refused for being larger than the frame limits, each of which closed its connection
+		std::uint64_t oversized_frames;
+
+		// times a connection stopped reading because its own unsent responses, or every connection's, were over budget
+		std::uint64_t connection_budget_pauses;
+		std::uint64_t global_budget_pauses;
+	};
+
+	// every thread records into counters of its own which only it writes, so recording never takes a lock
+	// or contends for a cache line, the counters are summed when a snapshot is taken
+	void count_accepted_connection();
+	void record_handshake(std::uint8_t is_valid, std::chrono::nanoseconds duration);
+
+	void count_bytes_in(std::uint64_t size);
+	void count_bytes_out(std::uint64_t size);
+
+	void count_request(request::request_id_t request_id);
+
+	// handler latency covers verifying and handling the body, end to end latency runs from the read which completed
+	// the request to the write which sent its response
+	void record_handler_latency(request::request_id_t request_id, std::chrono::nanoseconds duration);
+	void record_end_to_end_latency(request::request_id_t request_id, std::chrono::nanoseconds duration);
+
+	void record_write_queue_depth(std::uint64_t depth);
+
+	void count_oversized_frame();
+	void count_budget_pause(std::uint8_t is_global);
+
+	// summed over every thread that has recorded, including ones that have exited
+	snapshot_t snapshot();
+
+	// one json object on one line, with p50/p99/p999 for every histogram instead of its buckets
+	void write_json(std::ostream& stream, const snapshot_t& snapshot);
+}
@@ -0,0 +1,367 @@
+#include "socket.hpp"
+#include "../memory/pool.hpp"
+#include "../logging/logging.hpp"
+
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include <spdlog/spdlog.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+
+#include <array>
+#endif
+
+static auto make_handshake_operation(SSL* const ssl, const socket_t::handshake_type_t type)
+{
+	return [ssl, type]() -> std::int32_t
+	{
+		return type == socket_t::handshake_type_t::client ? SSL_connect(ssl) : SSL_accept(ssl);
+	};
+}
+
+static auto make_read_operation(SSL* const ssl, void* const buffer, const std::uint64_t size)
+{
+	return [ssl, bytes = static_cast<std::uint8_t*>(buffer), size, transferred = std::uint64_t(0)]() mutable -> std::int32_t
+	{
+		while (transferred < size)
+		{
+			std::size_t bytes_read = 0;
+
+			const std::int32_t result = SSL_read_ex(ssl, bytes + transferred, size - transferred, &bytes_read);
+
+			if (result != 1)
+			{
+				return result;
+			}
+
+			transferred += bytes_read;
+		}
+
+		return 1;
+	};
+}
+
+static auto make_read_some_operation(SSL* const ssl, void* const buffer, const std::uint64_t size, std::uint64_t& bytes_read)
+{
+	return [ssl, buffer, size, &bytes_read]() -> std::int32_t
+	{
+		std::size_t bytes_read_ = 0;
+
+		const std::int32_t result = SSL_read_ex(ssl, buffer, size, &bytes_read_);
+
+		bytes_read = bytes_read_;
+
+		return result;
+	};
+}
+
+// the stream's ssl object allows partial writes, so a write may take several calls
+static auto make_write_operation(SSL* const ssl, const void* const buffer, const std::uint64_t size)
+{
+	return [ssl, bytes = static_cast<const std::uint8_t*>(buffer), size, transferred = std::uint64_t(0)]() mutable -> std::int32_t
+	{
+		while (transferred < size)
+		{
+			std::size_t bytes_written = 0;
+
+			const std::int32_t result = SSL_write_ex(ssl, bytes + transferred, size - transferred, &bytes_written);
+
+			if (result != 1)
+			{
+				return result;
+			}
+
+			transferred += bytes_written;
+		}
+
+		return 1;
+	};
+}
+
+#ifndef _WIN32
+static auto make_send_file_operation(SSL* const ssl, const std::int32_t file_descriptor, const std::uint64_t offset, const std::uint64_t size)
+{
+	return [ssl, file_descriptor, offset, size, transferred = std::uint64_t(0)]() mutable -> std::int32_t
+	{
+		while (transferred < size)
+		{
+			const ossl_ssize_t bytes_sent = SSL_sendfile(ssl, file_descriptor, static_cast<off_t>(offset + transferred), size - transferred, 0);
+
+			if (bytes_sent <= 0)
+			{
+				return -1;
+			}
+
+			transferred += bytes_sent;
+		}
+
+		return 1;
+	};
+}
+#endif
+
+static boost::asio::socket_base::wait_type wait_type(SSL* const ssl, const std::int32_t result, std::uint8_t& is_valid)
+{
+	const std::int32_t error = SSL_get_error(ssl, result);
+
+	is_valid = error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE;
+
+	if (!is_valid)
+	{
+		const std::uint64_t error_code = ERR_get_error();
+
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "tls operation failed ({})", error_code != 0 ? ERR_reason_error_string(error_code) : "connection closed");
+
+		ERR_clear_error();
+	}
+
+	return error == SSL_ERROR_WANT_WRITE ? boost::asio::socket_base::wait_write : boost::asio::socket_base::wait_read;
+}
+
+void boost_tcp_socket_t::enable_kernel_tls()
+{
+	is_kernel_tls_ = 1;
+}
+
+boost_tcp_socket_t::tls_offload_t boost_tcp_socket_t::tls_offload() const
+{
+	if (!is_kernel_tls_)
+	{
+		return tls_offload_t::none;
+	}
+
+	SSL* const ssl = stream_->native_handle();
+
+	const std::uint8_t is_send_offloaded = BIO_ctrl(SSL_get_wbio(ssl), BIO_CTRL_GET_KTLS_SEND, 0, nullptr) > 0;
+	const std::uint8_t is_receive_offloaded = BIO_ctrl(SSL_get_rbio(ssl), BIO_CTRL_GET_KTLS_RECV, 0, nullptr) > 0;
+
+	if (is_send_offloaded && is_receive_offloaded)
+	{
+		return tls_offload_t::send_and_receive;
+	}
+
+	if (is_send_offloaded)
+	{
+		return tls_offload_t::send;
+	}
+
+	return is_receive_offloaded ? tls_offload_t::receive : tls_offload_t::none;
+}
+
+template <class operation_t>
+std::uint8_t boost_tcp_socket_t::run_direct(operation_t& operation)
+{
+	auto& socket = stream_->next_layer();
+
+	while (true)
+	{
+		const std::int32_t result = operation();
+
+		if (result == 1)
+		{
+			return 1;
+		}
+
+		std::uint8_t is_valid = 0;
+
+		const boost::asio::socket_base::wait_type wait = wait_type(stream_->native_handle(), result, is_valid);
+
+		if (!is_valid)
+		{
+			return 0;
+		}
+
+		boost::system::error_code error_code = { };
+
+		socket.wait(wait, error_code);
+
+		if (error_code)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
+			return 0;
+		}
+	}
+}
+
+template <class operation_t>
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_run_direct(operation_t operation)
+{
+	auto& socket = stream_->next_layer();
+
+	while (true)
+	{
+		const std::int32_t result = operation();
+
+		if (result == 1)
+		{
+			co_return 1;
+		}
+
+		std::uint8_t is_valid = 0;
+
+		const boost::asio::socket_base::wait_type wait = wait_type(stream_->native_handle(), result, is_valid);
+
+		if (!is_valid)
+		{
+			co_return 0;
+		}
+
+		boost::system::error_code error_code = { };
+
+		co_await socket.async_wait(wait, boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+		if (error_code)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
+			co_return 0;
+		}
+	}
+}
+
+// replaces the asio stream's memory bios, openssl can only pass keys to the kernel when it owns the socket
+void boost_tcp_socket_t::prepare_kernel_tls(const handshake_type_t type)
+{
+	SSL* const ssl = stream_->native_handle();
+
+	if (type == handshake_type_t::client)
+	{
+		ssl_context_->offer_session(ssl);
+	}
+
+	auto& socket = stream_->next_layer();
+
+	boost::system::error_code error_code = { };
+
+	// native, a user set non blocking mode would make the synchronous waits return immediately
+	socket.native_non_blocking(true, error_code);
+
+	SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+	SSL_set_fd(ssl, static_cast<std::int32_t>(socket.native_handle()));
+}
+
+std::uint8_t boost_tcp_socket_t::direct_handshake(const handshake_type_t type)
+{
+	prepare_kernel_tls(type);
+
+	auto operation = make_handshake_operation(stream_->native_handle(), type);
+
+	const std::uint8_t is_valid = run_direct(operation);
+
+	if (is_valid)
+	{
+		report_tls_offload();
+	}
+
+	return is_valid;
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_direct_handshake(const handshake_type_t type)
+{
+	prepare_kernel_tls(type);
+
+	const std::uint8_t is_valid = co_await co_run_direct(make_handshake_operation(stream_->native_handle(), type));
+
+	if (is_valid)
+	{
+		report_tls_offload();
+	}
+
+	co_return is_valid;
+}
+
+std::uint8_t boost_tcp_socket_t::direct_read(void* const buffer, const std::uint64_t size)
+{
+	auto operation = make_read_operation(stream_->native_handle(), buffer, size);
+
+	return run_direct(operation);
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_direct_read(void* const buffer, const std::uint64_t size)
+{
+	return co_run_direct(make_read_operation(stream_->native_handle(), buffer, size));
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_direct_read_some(void* const buffer, const std::uint64_t size, std::uint64_t& bytes_read)
+{
+	return co_run_direct(make_read_some_operation(stream_->native_handle(), buffer, size, bytes_read));
+}
+
+std::uint8_t boost_tcp_socket_t::direct_write(const void* const buffer, const std::uint64_t size)
+{
+	auto operation = make_write_operation(stream_->native_handle(), buffer, size);
+
+	return run_direct(operation);
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_direct_write(const void* const buffer, const std::uint64_t size)
+{
+	return co_run_direct(make_write_operation(stream_->native_handle(), buffer, size));
+}
+
+void boost_tcp_socket_t::spawn_direct(awaitable_t<std::uint8_t> operation, const async_callback_t& handler)
+{
+	boost::asio::co_spawn(executor(), std::move(operation), memory::bind_pool(
+		[handler](const std::exception_ptr&, const std::uint8_t is_valid)
+		{
+			handler(is_valid);
+		})
+	);
+}
+
+void boost_tcp_socket_t::report_tls_offload() const
+{
+	static constexpr std::array<const char*, 4> offload_names = { "none, encrypting in user space", "send", "receive", "send and receive" };
+
+	spdlog::info("kernel tls offload: {}", offload_names[static_cast<std::uint8_t>(tls_offload())]);
+}
+
+#ifndef _WIN32
+std::uint8_t boost_tcp_socket_t::send_file(const std::int32_t file_descriptor, const std::uint64_t offset, const std::uint64_t size)
+{
+	if (can_send_file_directly())
+	{
+		auto operation = make_send_file_operation(stream_->native_handle(), file_descriptor, offset, size);
+
+		return run_direct(operation);
+	}
+
+	// sent in chunks through the socket's ordinary write path when the kernel is not encrypting sends
+	std::vector<std::uint8_t> chunk(std::min(size, send_file_chunk_size));
+
+	for (std::uint64_t transferred = 0; transferred < size;)
+	{
+		const ssize_t bytes_read = pread(file_descriptor, chunk.data(), std::min(chunk.size(), size - transferred), static_cast<off_t>(offset + transferred));
+
+		if (bytes_read <= 0 || !write(chunk.data(), bytes_read))
+		{
+			return 0;
+		}
+
+		transferred += bytes_read;
+	}
+
+	return 1;
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_send_file(const std::int32_t file_descriptor, const std::uint64_t offset, const std::uint64_t size)
+{
+	if (can_send_file_directly())
+	{
+		co_return co_await co_run_direct(make_send_file_operation(stream_->native_handle(), file_descriptor, offset, size));
+	}
+
+	co_return co_await socket_t::co_send_file(file_descriptor, offset, size);
+}
+
+std::uint8_t boost_tcp_socket_t::can_send_file_directly() const
+{
+	const tls_offload_t offload = tls_offload();
+
+	return offload == tls_offload_t::send || offload == tls_offload_t::send_and_receive;
+}
+#endif
@@ -0,0 +1,384 @@
+#include "plain_socket.hpp"
+#include "../memory/pool.hpp"
+#include "../logging/logging.hpp"
+
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+
+#include <cerrno>
+#endif
+
+template <class protocol_t>
+static constexpr std::uint8_t is_tcp = std::is_same_v<protocol_t, boost::asio::ip::tcp>;
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::connect(const std::string_view& host, const std::string_view& service)
+{
+	boost::system::error_code error_code = { };
+
+	if constexpr (is_tcp<protocol_t>)
+	{
+		boost::asio::ip::tcp::resolver resolver(*io_context_);
+
+		const auto endpoints = resolver.resolve(host, service, error_code);
+
+		if (error_code)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
+			return 0;
+		}
+
+		boost::asio::connect(socket_, endpoints, error_code);
+	}
+	else
+	{
+		(void)service;
+
+		socket_.connect(asio_endpoint_t(host), error_code);
+	}
+
+	return !error_code.failed();
+}
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::connect(const std::uint32_t ipv4_address, const std::uint16_t port)
+{
+	if constexpr (is_tcp<protocol_t>)
+	{
+		return connect(asio_endpoint_t(boost::asio::ip::address_v4(ipv4_address), port));
+	}
+	else
+	{
+		spdlog::error("a unix domain socket cannot connect to {}:{}", boost::asio::ip::address_v4(ipv4_address).to_string(), port);
+
+		return 0;
+	}
+}
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::connect(const asio_endpoint_t& endpoint)
+{
+	boost::system::error_code error_code = { };
+
+	socket_.connect(endpoint, error_code);
+
+	return !error_code.failed();
+}
+
+template <class protocol_t>
+void boost_plain_socket_t<protocol_t>::close()
+{
+	// the peer may already have gone, which is not worth throwing over
+	boost::system::error_code error_code = { };
+
+	socket_.shutdown(asio_socket_t::shutdown_both, error_code);
+	socket_.close(error_code);
+}
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::handshake(const handshake_type_t)
+{
+	return 1;
+}
+
+template <class protocol_t>
+void boost_plain_socket_t<protocol_t>::async_handshake(const handshake_type_t, const async_callback_t& handler)
+{
+	// posted rather than called, so the handler never runs inside its caller like the tls socket's never does
+	boost::asio::post(socket_.get_executor(), memory::bind_pool(
+		[handler]()
+		{
+			handler(1);
+		})
+	);
+}
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::read(void* const buffer, const std::uint64_t size)
+{
+	boost::system::error_code error_code = { };
+
+	boost::asio::read(socket_, boost::asio::buffer(buffer, size), error_code);
+
+	return !error_code;
+}
+
+template <class protocol_t>
+void boost_plain_socket_t<protocol_t>::async_read(void* const buffer, const std::uint64_t size, const async_callback_t& handler)
+{
+	boost::asio::async_read(socket_, boost::asio::buffer(buffer, size),
+		memory::bind_pool([handler](const boost::system::error_code& error_code, const std::uint64_t)
+		{
+			const std::uint8_t is_valid = !error_code;
+
+			if (!is_valid)
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+			}
+
+			handler(is_valid);
+		})
+	);
+}
+
+template <class protocol_t>
+void boost_plain_socket_t<protocol_t>::async_read_some(void* const buffer, const std::uint64_t size, const async_size_callback_t& handler)
+{
+	socket_.async_read_some(boost::asio::buffer(buffer, size),
+		memory::bind_pool([handler](const boost::system::error_code& error_code, const std::uint64_t bytes_read)
+		{
+			const std::uint8_t is_valid = !error_code;
+
+			if (!is_valid)
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+			}
+
+			handler(is_valid, bytes_read);
+		})
+	);
+}
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::write(const void* const buffer, const std::uint64_t size)
+{
+	boost::system::error_code error_code = { };
+
+	boost::asio::write(socket_, boost::asio::buffer(buffer, size), error_code);
+
+	return !error_code;
+}
+
+template <class protocol_t>
+void boost_plain_socket_t<protocol_t>::async_write(const void* const buffer, const std::uint64_t size, const async_callback_t& handler)
+{
+	boost::asio::async_write(socket_, boost::asio::buffer(buffer, size),
+		memory::bind_pool([handler](const boost::system::error_code& error_code, const std::uint64_t)
+		{
+			const std::uint8_t is_valid = !error_code;
+
+			if (!is_valid)
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+			}
+
+			handler(is_valid);
+		})
+	);
+}
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::gather_write(const socket_buffers_t buffers)
+{
+	boost::system::error_code error_code = { };
+
+	boost::asio::write(socket_, gather(buffers), error_code);
+
+	return !error_code;
+}
+
+template <class protocol_t>
+void boost_plain_socket_t<protocol_t>::async_gather_write(const socket_buffers_t buffers, const async_callback_t& handler)
+{
+	boost::asio::async_write(socket_, coalesce(buffers),
+		memory::bind_pool([this, handler](const boost::system::error_code& error_code, const std::uint64_t)
+		{
+			const std::uint8_t is_valid = !error_code;
+
+			if (!is_valid)
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+			}
+
+			release_gather_buffer(gather_buffer_);
+
+			handler(is_valid);
+		})
+	);
+}
+
+template <class protocol_t>
+boost::asio::any_io_executor boost_plain_socket_t<protocol_t>::executor()
+{
+	return socket_.get_executor();
+}
+
+template <class protocol_t>
+awaitable_t<std::uint8_t> boost_plain_socket_t<protocol_t>::co_handshake(const handshake_type_t)
+{
+	co_return 1;
+}
+
+template <class protocol_t>
+awaitable_t<std::uint8_t> boost_plain_socket_t<protocol_t>::co_read(void* const buffer, const std::uint64_t size)
+{
+	boost::system::error_code error_code = { };
+
+	co_await boost::asio::async_read(socket_, boost::asio::buffer(buffer, size), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+template <class protocol_t>
+awaitable_t<std::uint8_t> boost_plain_socket_t<protocol_t>::co_read_some(void* const buffer, const std::uint64_t size, std::uint64_t& bytes_read)
+{
+	boost::system::error_code error_code = { };
+
+	bytes_read = co_await socket_.async_read_some(boost::asio::buffer(buffer, size), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+template <class protocol_t>
+awaitable_t<std::uint8_t> boost_plain_socket_t<protocol_t>::co_write(const void* const buffer, const std::uint64_t size)
+{
+	boost::system::error_code error_code = { };
+
+	co_await boost::asio::async_write(socket_, boost::asio::buffer(buffer, size), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+template <class protocol_t>
+awaitable_t<std::uint8_t> boost_plain_socket_t<protocol_t>::co_gather_write(const socket_buffers_t buffers)
+{
+	boost::system::error_code error_code = { };
+
+	co_await boost::asio::async_write(socket_, gather(buffers), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+#ifdef __linux__
+template <class protocol_t>
+awaitable_t<std::uint8_t> boost_plain_socket_t<protocol_t>::co_send_file(const std::int32_t file_descriptor, const std::uint64_t offset, const std::uint64_t size)
+{
+	boost::system::error_code error_code = { };
+
+	// a full socket buffer then fails sendfile with EAGAIN instead of blocking the thread, and is waited out like an async write
+	socket_.native_non_blocking(true, error_code);
+
+	off_t file_offset = static_cast<off_t>(offset);
+
+	for (std::uint64_t remaining = size; remaining > 0 && !error_code;)
+	{
+		const ssize_t bytes_sent = sendfile(socket_.native_handle(), file_descriptor, &file_offset, remaining);
+
+		if (bytes_sent > 0)
+		{
+			remaining -= bytes_sent;
+		}
+		else if (bytes_sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			co_await socket_.async_wait(asio_socket_t::wait_write, boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+		}
+		// the file ended before the range did
+		else if (bytes_sent == 0)
+		{
+			error_code = boost::asio::error::eof;
+		}
+		else if (errno != EINTR)
+		{
+			error_code = boost::system::error_code(errno, boost::system::system_category());
+		}
+	}
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+template <class protocol_t>
+std::uint8_t boost_plain_socket_t<protocol_t>::can_send_file_directly() const
+{
+	return 1;
+}
+#endif
+
+template <class protocol_t>
+std::uint32_t boost_plain_socket_t<protocol_t>::ipv4_address()
+{
+	if constexpr (is_tcp<protocol_t>)
+	{
+		const auto address = socket_.remote_endpoint().address();
+
+		return address.to_v4().to_uint();
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+template <class protocol_t>
+std::uint16_t boost_plain_socket_t<protocol_t>::port()
+{
+	if constexpr (is_tcp<protocol_t>)
+	{
+		return socket_.local_endpoint().port();
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+template <class protocol_t>
+const std::vector<boost::asio::const_buffer>& boost_plain_socket_t<protocol_t>::gather(const socket_buffers_t buffers)
+{
+	gather_buffers_.clear();
+
+	for (const socket_buffer_t& buffer : buffers)
+	{
+		gather_buffers_.emplace_back(buffer.data, buffer.size);
+	}
+
+	return gather_buffers_;
+}
+
+template <class protocol_t>
+boost::asio::const_buffer boost_plain_socket_t<protocol_t>::coalesce(const socket_buffers_t buffers)
+{
+	gather_buffer_.clear();
+
+	for (const socket_buffer_t& buffer : buffers)
+	{
+		const auto buffer_begin = static_cast<const std::uint8_t*>(buffer.data);
+
+		gather_buffer_.insert(gather_buffer_.end(), buffer_begin, buffer_begin + buffer.size);
+	}
+
+	return boost::asio::buffer(gather_buffer_);
+}
+
+template class boost_plain_socket_t<boost::asio::ip::tcp>;
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+template class boost_plain_socket_t<boost::asio::local::stream_protocol>;
+#endif
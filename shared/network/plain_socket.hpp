@@ -0,0 +1,80 @@
+#pragma once
+#include "socket.hpp"
+
+// a stream socket without tls, for traffic which stays on the host or is protected by other means,
+// its handshake routines complete straight away so it can stand in for a tls socket anywhere
+template <class protocol_t>
+class boost_plain_socket_t final : public socket_t
+{
+public:
+	typedef boost::asio::io_context asio_context_t;
+	typedef typename protocol_t::socket asio_socket_t;
+	typedef typename protocol_t::endpoint asio_endpoint_t;
+
+	explicit boost_plain_socket_t(std::shared_ptr<asio_context_t> io_context)
+		:	io_context_(std::move(io_context)),
+			socket_(*io_context_) {}
+
+	explicit boost_plain_socket_t(std::shared_ptr<asio_context_t> io_context, asio_socket_t socket)
+		:	io_context_(std::move(io_context)),
+			socket_(std::move(socket)) {}
+
+	// for a unix domain socket the host is the socket's path and the service is ignored
+	std::uint8_t connect(const std::string_view& host, const std::string_view& service) override;
+	std::uint8_t connect(std::uint32_t ipv4_address, std::uint16_t port) override;
+	std::uint8_t connect(const asio_endpoint_t& endpoint);
+
+	void close() override;
+
+	std::uint8_t handshake(handshake_type_t type) override;
+	void async_handshake(handshake_type_t type, const async_callback_t& handler) override;
+
+	std::uint8_t read(void* buffer, std::uint64_t size) override;
+	void async_read(void* buffer, std::uint64_t size, const async_callback_t& handler) override;
+	void async_read_some(void* buffer, std::uint64_t size, const async_size_callback_t& handler) override;
+
+	std::uint8_t write(const void* buffer, std::uint64_t size) override;
+	void async_write(const void* buffer, std::uint64_t size, const async_callback_t& handler) override;
+
+	// the synchronous and awaitable gather writes hand the buffers to the kernel as they are,
+	// the callback gather write coalesces them as it has to copy them anyway
+	std::uint8_t gather_write(socket_buffers_t buffers) override;
+	void async_gather_write(socket_buffers_t buffers, const async_callback_t& handler) override;
+
+	[[nodiscard]] boost::asio::any_io_executor executor() override;
+
+	awaitable_t<std::uint8_t> co_handshake(handshake_type_t type) override;
+	awaitable_t<std::uint8_t> co_read(void* buffer, std::uint64_t size) override;
+	awaitable_t<std::uint8_t> co_read_some(void* buffer, std::uint64_t size, std::uint64_t& bytes_read) override;
+	awaitable_t<std::uint8_t> co_write(const void* buffer, std::uint64_t size) override;
+	awaitable_t<std::uint8_t> co_gather_write(socket_buffers_t buffers) override;
+
+#ifdef __linux__
+	// the file is sent with sendfile, straight from the page cache
+	awaitable_t<std::uint8_t> co_send_file(std::int32_t file_descriptor, std::uint64_t offset, std::uint64_t size) override;
+	[[nodiscard]] std::uint8_t can_send_file_directly() const override;
+#endif
+
+	// zero for a unix domain socket, which has neither
+	[[nodiscard]] std::uint32_t ipv4_address() override;
+	[[nodiscard]] std::uint16_t port() override;
+
+protected:
+	[[nodiscard]] const std::vector<boost::asio::const_buffer>& gather(socket_buffers_t buffers);
+	[[nodiscard]] boost::asio::const_buffer coalesce(socket_buffers_t buffers);
+
+	std::shared_ptr<asio_context_t> io_context_;
+	asio_socket_t socket_;
+	std::vector<boost::asio::const_buffer> gather_buffers_;
+	std::vector<std::uint8_t> gather_buffer_;
+};
+
+typedef boost_plain_socket_t<boost::asio::ip::tcp> boost_plain_tcp_socket_t;
+
+extern template class boost_plain_socket_t<boost::asio::ip::tcp>;
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+typedef boost_plain_socket_t<boost::asio::local::stream_protocol> boost_unix_socket_t;
+
+extern template class boost_plain_socket_t<boost::asio::local::stream_protocol>;
+#endif
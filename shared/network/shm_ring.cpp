@@ -0,0 +1,179 @@
+#include "shm_ring.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+static constexpr std::uint64_t header_footprint = (sizeof(shm::ring_header_t) + shm::cache_line_size - 1) & ~(shm::cache_line_size - 1);
+
+shm::ring_t::ring_t(void* const memory, const std::uint64_t capacity)
+	:	header_(static_cast<ring_header_t*>(memory)),
+		data_(static_cast<std::uint8_t*>(memory) + header_footprint),
+		capacity_(capacity) {}
+
+std::uint64_t shm::ring_t::footprint(const std::uint64_t capacity)
+{
+	return header_footprint + capacity;
+}
+
+void shm::ring_t::initialise(void* const memory)
+{
+	new (memory) ring_header_t();
+}
+
+std::uint64_t shm::ring_t::used_bytes(const std::uint64_t head, const std::uint64_t tail)
+{
+	const std::uint64_t used_bytes = head - tail;
+
+	if (used_bytes > capacity_)
+	{
+		is_corrupt_ = 1;
+
+		close();
+
+		return 0;
+	}
+
+	return used_bytes;
+}
+
+std::uint64_t shm::ring_t::write(const void* const buffer, const std::uint64_t size)
+{
+	if (is_corrupt_)
+	{
+		return 0;
+	}
+
+	const std::uint64_t head = position_;
+	const std::uint64_t tail = header_->tail.load(std::memory_order_acquire);
+
+	const std::uint64_t used = used_bytes(head, tail);
+
+	if (is_corrupt_)
+	{
+		return 0;
+	}
+
+	const std::uint64_t count = std::min(size, capacity_ - used);
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	const std::uint64_t offset = head & (capacity_ - 1);
+	const std::uint64_t first_part = std::min(count, capacity_ - offset);
+
+	const auto bytes = static_cast<const std::uint8_t*>(buffer);
+
+	std::memcpy(data_ + offset, bytes, first_part);
+	std::memcpy(data_, bytes + first_part, count - first_part);
+
+	position_ = head + count;
+
+	header_->head.store(position_, std::memory_order_release);
+
+	return count;
+}
+
+std::uint64_t shm::ring_t::read(void* const buffer, const std::uint64_t size)
+{
+	if (is_corrupt_)
+	{
+		return 0;
+	}
+
+	const std::uint64_t tail = position_;
+	const std::uint64_t head = header_->head.load(std::memory_order_acquire);
+
+	// used_bytes never exceeds the capacity, so neither does the copy
+	const std::uint64_t count = std::min(size, used_bytes(head, tail));
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	const std::uint64_t offset = tail & (capacity_ - 1);
+	const std::uint64_t first_part = std::min(count, capacity_ - offset);
+
+	const auto bytes = static_cast<std::uint8_t*>(buffer);
+
+	std::memcpy(bytes, data_ + offset, first_part);
+	std::memcpy(bytes + first_part, data_, count - first_part);
+
+	position_ = tail + count;
+
+	header_->tail.store(position_, std::memory_order_release);
+
+	return count;
+}
+
+// the fences pair with the ones in the arm routines, so either the sleeper sees the new position
+// or the other end sees its flag
+std::uint8_t shm::ring_t::take_reader_wakeup()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	return header_->is_reader_waiting.load(std::memory_order_relaxed) && header_->is_reader_waiting.exchange(0, std::memory_order_relaxed);
+}
+
+std::uint8_t shm::ring_t::take_writer_wakeup()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	return header_->is_writer_waiting.load(std::memory_order_relaxed) && header_->is_writer_waiting.exchange(0, std::memory_order_relaxed);
+}
+
+std::uint8_t shm::ring_t::arm_read_wait()
+{
+	header_->is_reader_waiting.store(1, std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (!is_empty() || is_closed())
+	{
+		header_->is_reader_waiting.store(0, std::memory_order_relaxed);
+
+		return 0;
+	}
+
+	return 1;
+}
+
+std::uint8_t shm::ring_t::arm_write_wait()
+{
+	header_->is_writer_waiting.store(1, std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (!is_full() || is_closed())
+	{
+		header_->is_writer_waiting.store(0, std::memory_order_relaxed);
+
+		return 0;
+	}
+
+	return 1;
+}
+
+void shm::ring_t::close()
+{
+	header_->is_closed.store(1, std::memory_order_release);
+}
+
+// the peer could clear the shared flag again, so a ring closed over a corrupt position stays closed here
+std::uint8_t shm::ring_t::is_closed() const
+{
+	return is_corrupt_ || header_->is_closed.load(std::memory_order_acquire) != 0;
+}
+
+std::uint8_t shm::ring_t::is_empty() const
+{
+	return is_corrupt_ || header_->head.load(std::memory_order_acquire) == position_;
+}
+
+std::uint8_t shm::ring_t::is_full() const
+{
+	return !is_corrupt_ && position_ - header_->tail.load(std::memory_order_acquire) == capacity_;
+}
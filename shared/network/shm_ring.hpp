@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace shm
+{
+	constexpr std::uint64_t cache_line_size = 64;
+
+	// sits at the start of each ring in the shared segment, head and tail are on their own cache lines
+	// so the producer and consumer only touch each other's line to read its position
+	struct ring_header_t
+	{
+		alignas(cache_line_size) std::atomic<std::uint64_t> head;
+		alignas(cache_line_size) std::atomic<std::uint64_t> tail;
+		alignas(cache_line_size) std::atomic<std::uint32_t> is_reader_waiting;
+		std::atomic<std::uint32_t> is_writer_waiting;
+		std::atomic<std::uint32_t> is_closed;
+	};
+
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free, "the rings are shared between processes, which needs lock free atomics");
+
+	// single producer single consumer byte ring, head and tail count every byte ever written and read
+	// the capacity must be a power of two, an instance is either the writing or the reading end
+	//
+	// the peer can write anything to the segment, so each end keeps its own position privately and only publishes it
+	// there, and a peer position more than the capacity away from it closes the ring instead of being copied from
+	class ring_t
+	{
+	public:
+		ring_t() = default;
+		ring_t(void* memory, std::uint64_t capacity);
+
+		// the bytes a ring of capacity takes up in the segment, a multiple of the cache line size
+		[[nodiscard]] static std::uint64_t footprint(std::uint64_t capacity);
+
+		// constructs an empty ring's header, once, by whichever end creates the segment
+		static void initialise(void* memory);
+
+		// copy up to size bytes, returning how many were copied, which is zero when the ring is full, empty or closed
+		std::uint64_t write(const void* buffer, std::uint64_t size);
+		std::uint64_t read(void* buffer, std::uint64_t size);
+
+		// called after a write or read, returns whether the other end went to sleep and must be woken
+		[[nodiscard]] std::uint8_t take_reader_wakeup();
+		[[nodiscard]] std::uint8_t take_writer_wakeup();
+
+		// announces that the caller is going to sleep, returns 0 if the ring changed meanwhile so it should retry instead
+		[[nodiscard]] std::uint8_t arm_read_wait();
+		[[nodiscard]] std::uint8_t arm_write_wait();
+
+		void close();
+
+		[[nodiscard]] std::uint8_t is_closed() const;
+
+		// asked by the reading end and the writing end respectively
+		[[nodiscard]] std::uint8_t is_empty() const;
+		[[nodiscard]] std::uint8_t is_full() const;
+
+	protected:
+		// the bytes between this end's position and the peer's, closes the ring and returns 0 if the peer's is out of range
+		[[nodiscard]] std::uint64_t used_bytes(std::uint64_t head, std::uint64_t tail);
+
+		ring_header_t* header_ = nullptr;
+		std::uint8_t* data_ = nullptr;
+		std::uint64_t capacity_ = 0;
+
+		// head for the writing end and tail for the reading end, in this process's memory
+		std::uint64_t position_ = 0;
+		std::uint8_t is_corrupt_ = 0;
+	};
+}
@@ -0,0 +1,831 @@
+#include "shm_socket.hpp"
+
+#ifdef __linux__
+#include "../memory/pool.hpp"
+#include "../logging/logging.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+// the segment's memfd and the four eventfds, in the order they are passed to the client
+static constexpr std::uint64_t event_count = 4;
+static constexpr std::uint64_t descriptor_count = event_count + 1;
+
+static constexpr std::uint64_t minimum_ring_capacity = 4096;
+
+// the first ring carries the server's sends and the second the client's, each with a data and a space event
+struct shm_channel_t
+{
+	typedef boost_shm_socket_t::descriptor_t descriptor_t;
+
+	shm_channel_t(boost::asio::io_context& io_context, void* const mapping, const std::uint64_t mapping_size, const std::uint64_t capacity, const std::uint8_t is_server, const std::array<std::int32_t, event_count>& events)
+		:	mapping(mapping),
+			mapping_size(mapping_size),
+			send_ring(static_cast<std::uint8_t*>(mapping) + (is_server ? 0 : shm::ring_t::footprint(capacity)), capacity),
+			receive_ring(static_cast<std::uint8_t*>(mapping) + (is_server ? shm::ring_t::footprint(capacity) : 0), capacity),
+			send_data_event(io_context, events[is_server ? 0 : 2]),
+			send_space_event(io_context, events[is_server ? 1 : 3]),
+			receive_data_event(io_context, events[is_server ? 2 : 0]),
+			receive_space_event(io_context, events[is_server ? 3 : 1]) {}
+
+	~shm_channel_t()
+	{
+		munmap(mapping, mapping_size);
+	}
+
+	// marks both rings closed and wakes whoever sleeps on either end
+	void close()
+	{
+		send_ring.close();
+		receive_ring.close();
+
+		signal(send_data_event);
+		signal(send_space_event);
+		signal(receive_data_event);
+		signal(receive_space_event);
+	}
+
+	static void signal(descriptor_t& event)
+	{
+		eventfd_write(event.native_handle(), 1);
+	}
+
+	// the eventfds are non blocking, so this only clears a pending wakeup
+	static void drain(descriptor_t& event)
+	{
+		eventfd_t value = 0;
+
+		eventfd_read(event.native_handle(), &value);
+	}
+
+	void* mapping;
+	std::uint64_t mapping_size;
+
+	shm::ring_t send_ring;
+	shm::ring_t receive_ring;
+
+	descriptor_t send_data_event;
+	descriptor_t send_space_event;
+	descriptor_t receive_data_event;
+	descriptor_t receive_space_event;
+};
+
+static void log_errno(const char* const operation)
+{
+	spdlog::error("{} failed ({})", operation, std::strerror(errno));
+}
+
+static void close_descriptors(const std::span<const std::int32_t> descriptors)
+{
+	for (const std::int32_t descriptor : descriptors)
+	{
+		if (descriptor >= 0)
+		{
+			::close(descriptor);
+		}
+	}
+}
+
+static std::uint8_t send_descriptors(const std::int32_t socket, const std::uint64_t capacity, const std::array<std::int32_t, descriptor_count>& descriptors)
+{
+	std::uint64_t payload = capacity;
+
+	iovec io_vector = { .iov_base = &payload, .iov_len = sizeof(payload) };
+
+	alignas(cmsghdr) std::array<std::uint8_t, CMSG_SPACE(sizeof(descriptors))> control = { };
+
+	msghdr message = { };
+
+	message.msg_iov = &io_vector;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data();
+	message.msg_controllen = control.size();
+
+	cmsghdr* const header = CMSG_FIRSTHDR(&message);
+
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(descriptors));
+
+	std::memcpy(CMSG_DATA(header), descriptors.data(), sizeof(descriptors));
+
+	if (sendmsg(socket, &message, MSG_NOSIGNAL) != sizeof(payload))
+	{
+		log_errno("sending the shared memory channel");
+
+		return 0;
+	}
+
+	return 1;
+}
+
+// descriptors passed with a message that is then refused would otherwise stay open in this process
+static void close_passed_descriptors(msghdr& message)
+{
+	for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header))
+	{
+		if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS || header->cmsg_len < CMSG_LEN(0))
+		{
+			continue;
+		}
+
+		const std::uint64_t passed_count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(std::int32_t);
+
+		for (std::uint64_t i = 0; i < passed_count; i++)
+		{
+			std::int32_t descriptor = -1;
+
+			std::memcpy(&descriptor, CMSG_DATA(header) + i * sizeof(descriptor), sizeof(descriptor));
+
+			::close(descriptor);
+		}
+	}
+}
+
+static std::uint8_t receive_descriptors(const std::int32_t socket, std::uint64_t& capacity, std::array<std::int32_t, descriptor_count>& descriptors)
+{
+	iovec io_vector = { .iov_base = &capacity, .iov_len = sizeof(capacity) };
+
+	alignas(cmsghdr) std::array<std::uint8_t, CMSG_SPACE(sizeof(descriptors))> control = { };
+
+	msghdr message = { };
+
+	message.msg_iov = &io_vector;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data();
+	message.msg_controllen = control.size();
+
+	const ssize_t received = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+
+	if (received < 0)
+	{
+		log_errno("receiving the shared memory channel");
+
+		return 0;
+	}
+
+	const cmsghdr* const header = CMSG_FIRSTHDR(&message);
+
+	if (header == nullptr || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS || header->cmsg_len != CMSG_LEN(sizeof(descriptors)))
+	{
+		spdlog::error("received a malformed shared memory channel");
+
+		close_passed_descriptors(message);
+
+		return 0;
+	}
+
+	std::memcpy(descriptors.data(), CMSG_DATA(header), sizeof(descriptors));
+
+	if (received != sizeof(capacity) || (message.msg_flags & MSG_CTRUNC) || !std::has_single_bit(capacity) || capacity < minimum_ring_capacity)
+	{
+		spdlog::error("received a malformed shared memory channel");
+
+		close_descriptors(descriptors);
+
+		return 0;
+	}
+
+	return 1;
+}
+
+// waits on the eventfd, or on the control socket which turns readable once the peer has gone
+static std::uint8_t poll_event(const std::int32_t event, const std::int32_t socket)
+{
+	std::array<pollfd, 2> descriptors = { { { .fd = event, .events = POLLIN, .revents = 0 }, { .fd = socket, .events = POLLIN, .revents = 0 } } };
+
+	while (poll(descriptors.data(), descriptors.size(), -1) < 0)
+	{
+		if (errno != EINTR)
+		{
+			return 0;
+		}
+	}
+
+	return descriptors[1].revents == 0;
+}
+
+template <class is_ready_t>
+static std::uint8_t spin(const std::chrono::nanoseconds busy_poll, const is_ready_t& is_ready)
+{
+	if (busy_poll.count() == 0)
+	{
+		return 0;
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + busy_poll;
+
+	do
+	{
+		if (is_ready())
+		{
+			return 1;
+		}
+
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+	}
+	while (std::chrono::steady_clock::now() < deadline);
+
+	return 0;
+}
+
+std::uint8_t boost_shm_socket_t::connect(const std::string_view& host, const std::string_view&)
+{
+	boost::system::error_code error_code = { };
+
+	socket_.connect(asio_endpoint_t(host), error_code);
+
+	return !error_code.failed();
+}
+
+std::uint8_t boost_shm_socket_t::connect(const std::uint32_t ipv4_address, const std::uint16_t port)
+{
+	spdlog::error("a shared memory socket cannot connect to {}:{}", boost::asio::ip::address_v4(ipv4_address).to_string(), port);
+
+	return 0;
+}
+
+void boost_shm_socket_t::close()
+{
+	if (channel_)
+	{
+		channel_->close();
+	}
+
+	// the peer may already have gone, which is not worth throwing over
+	boost::system::error_code error_code = { };
+
+	socket_.shutdown(asio_socket_t::shutdown_both, error_code);
+	socket_.close(error_code);
+}
+
+std::uint8_t boost_shm_socket_t::handshake(const handshake_type_t type)
+{
+	if (type == handshake_type_t::server)
+	{
+		return offer_channel();
+	}
+
+	std::array<pollfd, 1> descriptors = { { { .fd = socket_.native_handle(), .events = POLLIN, .revents = 0 } } };
+
+	if (poll(descriptors.data(), descriptors.size(), -1) < 0)
+	{
+		log_errno("waiting for the shared memory channel");
+
+		return 0;
+	}
+
+	return accept_channel();
+}
+
+void boost_shm_socket_t::async_handshake(const handshake_type_t type, const async_callback_t& handler)
+{
+	if (type == handshake_type_t::server)
+	{
+		const std::uint8_t is_valid = offer_channel();
+
+		// posted rather than called, so the handler never runs inside its caller like the tls socket's never does
+		boost::asio::post(socket_.get_executor(), memory::bind_pool(
+			[handler, is_valid]()
+			{
+				handler(is_valid);
+			})
+		);
+
+		return;
+	}
+
+	socket_.async_wait(asio_socket_t::wait_read,
+		memory::bind_pool([this, handler](const boost::system::error_code& error_code)
+		{
+			if (error_code)
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
+				handler(0);
+
+				return;
+			}
+
+			handler(accept_channel());
+		})
+	);
+}
+
+std::uint8_t boost_shm_socket_t::read(void* const buffer, const std::uint64_t size)
+{
+	const auto bytes = static_cast<std::uint8_t*>(buffer);
+
+	for (std::uint64_t transferred = 0; transferred < size;)
+	{
+		const std::uint64_t bytes_read = receive(bytes + transferred, size - transferred);
+
+		if (bytes_read != 0)
+		{
+			transferred += bytes_read;
+		}
+		else if (!wait_readable())
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void boost_shm_socket_t::async_read(void* const buffer, const std::uint64_t size, const async_callback_t& handler)
+{
+	spawn(co_read(buffer, size), handler);
+}
+
+void boost_shm_socket_t::async_read_some(void* const buffer, const std::uint64_t size, const async_size_callback_t& handler)
+{
+	boost::asio::co_spawn(executor(),
+		[this, buffer, size]() -> awaitable_t<std::pair<std::uint8_t, std::uint64_t>>
+		{
+			std::uint64_t bytes_read = 0;
+
+			const std::uint8_t is_valid = co_await co_read_some(buffer, size, bytes_read);
+
+			co_return std::pair(is_valid, bytes_read);
+		},
+		memory::bind_pool([handler](const std::exception_ptr&, const std::pair<std::uint8_t, std::uint64_t> result)
+		{
+			handler(result.first, result.second);
+		})
+	);
+}
+
+std::uint8_t boost_shm_socket_t::write(const void* const buffer, const std::uint64_t size)
+{
+	const auto bytes = static_cast<const std::uint8_t*>(buffer);
+
+	for (std::uint64_t transferred = 0; transferred < size;)
+	{
+		if (!channel_ || channel_->send_ring.is_closed())
+		{
+			return 0;
+		}
+
+		const std::uint64_t bytes_written = send(bytes + transferred, size - transferred);
+
+		if (bytes_written != 0)
+		{
+			transferred += bytes_written;
+		}
+		else if (!wait_writable())
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void boost_shm_socket_t::async_write(const void* const buffer, const std::uint64_t size, const async_callback_t& handler)
+{
+	spawn(co_write(buffer, size), handler);
+}
+
+std::uint8_t boost_shm_socket_t::gather_write(const socket_buffers_t buffers)
+{
+	for (const socket_buffer_t& buffer : buffers)
+	{
+		if (!write(buffer.data, buffer.size))
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void boost_shm_socket_t::async_gather_write(const socket_buffers_t buffers, const async_callback_t& handler)
+{
+	gather_buffer_.clear();
+
+	for (const socket_buffer_t& buffer : buffers)
+	{
+		const auto buffer_begin = static_cast<const std::uint8_t*>(buffer.data);
+
+		gather_buffer_.insert(gather_buffer_.end(), buffer_begin, buffer_begin + buffer.size);
+	}
+
+	spawn(co_write(gather_buffer_.data(), gather_buffer_.size()),
+		[this, handler](const std::uint8_t is_valid)
+		{
+			release_gather_buffer(gather_buffer_);
+
+			handler(is_valid);
+		}
+	);
+}
+
+boost::asio::any_io_executor boost_shm_socket_t::executor()
+{
+	return socket_.get_executor();
+}
+
+awaitable_t<std::uint8_t> boost_shm_socket_t::co_handshake(const handshake_type_t type)
+{
+	if (type == handshake_type_t::server)
+	{
+		co_return offer_channel();
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await socket_.async_wait(asio_socket_t::wait_read, boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
+		co_return 0;
+	}
+
+	co_return accept_channel();
+}
+
+awaitable_t<std::uint8_t> boost_shm_socket_t::co_read(void* const buffer, const std::uint64_t size)
+{
+	const std::shared_ptr<shm_channel_t> channel = channel_;
+
+	const auto bytes = static_cast<std::uint8_t*>(buffer);
+
+	for (std::uint64_t transferred = 0; transferred < size;)
+	{
+		const std::uint64_t bytes_read = receive(bytes + transferred, size - transferred);
+
+		if (bytes_read != 0)
+		{
+			transferred += bytes_read;
+		}
+		else if (!co_await co_wait_readable(channel))
+		{
+			co_return 0;
+		}
+	}
+
+	co_return 1;
+}
+
+awaitable_t<std::uint8_t> boost_shm_socket_t::co_read_some(void* const buffer, const std::uint64_t size, std::uint64_t& bytes_read)
+{
+	const std::shared_ptr<shm_channel_t> channel = channel_;
+
+	while (true)
+	{
+		bytes_read = receive(buffer, size);
+
+		if (bytes_read != 0)
+		{
+			co_return 1;
+		}
+
+		if (!co_await co_wait_readable(channel))
+		{
+			co_return 0;
+		}
+	}
+}
+
+awaitable_t<std::uint8_t> boost_shm_socket_t::co_write(const void* const buffer, const std::uint64_t size)
+{
+	const std::shared_ptr<shm_channel_t> channel = channel_;
+
+	const auto bytes = static_cast<const std::uint8_t*>(buffer);
+
+	for (std::uint64_t transferred = 0; transferred < size;)
+	{
+		if (!channel || channel->send_ring.is_closed())
+		{
+			co_return 0;
+		}
+
+		const std::uint64_t bytes_written = send(bytes + transferred, size - transferred);
+
+		if (bytes_written != 0)
+		{
+			transferred += bytes_written;
+		}
+		else if (!co_await co_wait_writable(channel))
+		{
+			co_return 0;
+		}
+	}
+
+	co_return 1;
+}
+
+awaitable_t<std::uint8_t> boost_shm_socket_t::co_gather_write(const socket_buffers_t buffers)
+{
+	for (const socket_buffer_t& buffer : buffers)
+	{
+		if (!co_await co_write(buffer.data, buffer.size))
+		{
+			co_return 0;
+		}
+	}
+
+	co_return 1;
+}
+
+std::uint32_t boost_shm_socket_t::ipv4_address()
+{
+	return 0;
+}
+
+std::uint16_t boost_shm_socket_t::port()
+{
+	return 0;
+}
+
+void boost_shm_socket_t::set_ring_capacity(const std::uint64_t capacity)
+{
+	ring_capacity_ = std::bit_ceil(std::max(capacity, minimum_ring_capacity));
+}
+
+void boost_shm_socket_t::set_busy_poll(const std::chrono::nanoseconds busy_poll)
+{
+	busy_poll_ = busy_poll;
+}
+
+std::uint8_t boost_shm_socket_t::offer_channel()
+{
+	std::array<std::int32_t, descriptor_count> descriptors = { };
+
+	descriptors.fill(-1);
+
+	const std::uint64_t mapping_size = 2 * shm::ring_t::footprint(ring_capacity_);
+
+	descriptors[0] = memfd_create("socketsl_shm", MFD_CLOEXEC);
+
+	if (descriptors[0] < 0 || ftruncate(descriptors[0], static_cast<off_t>(mapping_size)) != 0)
+	{
+		log_errno("creating the shared memory segment");
+		close_descriptors(descriptors);
+
+		return 0;
+	}
+
+	for (std::uint64_t i = 1; i < descriptor_count; i++)
+	{
+		descriptors[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+		if (descriptors[i] < 0)
+		{
+			log_errno("creating the shared memory events");
+			close_descriptors(descriptors);
+
+			return 0;
+		}
+	}
+
+	void* const mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptors[0], 0);
+
+	if (mapping == MAP_FAILED)
+	{
+		log_errno("mapping the shared memory segment");
+		close_descriptors(descriptors);
+
+		return 0;
+	}
+
+	shm::ring_t::initialise(mapping);
+	shm::ring_t::initialise(static_cast<std::uint8_t*>(mapping) + shm::ring_t::footprint(ring_capacity_));
+
+	const std::uint8_t is_sent = send_descriptors(socket_.native_handle(), ring_capacity_, descriptors);
+
+	// the mapping keeps the segment alive, and the client has its own copy of every descriptor
+	::close(descriptors[0]);
+
+	std::array<std::int32_t, event_count> events = { };
+
+	std::copy(descriptors.begin() + 1, descriptors.end(), events.begin());
+
+	if (!is_sent)
+	{
+		munmap(mapping, mapping_size);
+		close_descriptors(events);
+
+		return 0;
+	}
+
+	channel_ = std::make_shared<shm_channel_t>(*io_context_, mapping, mapping_size, ring_capacity_, 1, events);
+
+	watch_peer();
+
+	return 1;
+}
+
+std::uint8_t boost_shm_socket_t::accept_channel()
+{
+	std::uint64_t capacity = 0;
+	std::array<std::int32_t, descriptor_count> descriptors = { };
+
+	if (!receive_descriptors(socket_.native_handle(), capacity, descriptors))
+	{
+		return 0;
+	}
+
+	const std::uint64_t mapping_size = 2 * shm::ring_t::footprint(capacity);
+
+	void* const mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptors[0], 0);
+
+	::close(descriptors[0]);
+
+	std::array<std::int32_t, event_count> events = { };
+
+	std::copy(descriptors.begin() + 1, descriptors.end(), events.begin());
+
+	if (mapping == MAP_FAILED)
+	{
+		log_errno("mapping the shared memory segment");
+		close_descriptors(events);
+
+		return 0;
+	}
+
+	channel_ = std::make_shared<shm_channel_t>(*io_context_, mapping, mapping_size, capacity, 0, events);
+
+	watch_peer();
+
+	return 1;
+}
+
+void boost_shm_socket_t::watch_peer()
+{
+	socket_.async_wait(asio_socket_t::wait_read,
+		memory::bind_pool([weak_channel = std::weak_ptr(channel_)](const boost::system::error_code& error_code)
+		{
+			const std::shared_ptr<shm_channel_t> channel = weak_channel.lock();
+
+			if (error_code != boost::asio::error::operation_aborted && channel)
+			{
+				channel->close();
+			}
+		})
+	);
+}
+
+std::uint64_t boost_shm_socket_t::send(const void* const buffer, const std::uint64_t size)
+{
+	const std::uint64_t bytes_written = channel_->send_ring.write(buffer, size);
+
+	if (bytes_written != 0 && channel_->send_ring.take_reader_wakeup())
+	{
+		shm_channel_t::signal(channel_->send_data_event);
+	}
+
+	return bytes_written;
+}
+
+std::uint64_t boost_shm_socket_t::receive(void* const buffer, const std::uint64_t size)
+{
+	if (!channel_)
+	{
+		return 0;
+	}
+
+	const std::uint64_t bytes_read = channel_->receive_ring.read(buffer, size);
+
+	if (bytes_read != 0 && channel_->receive_ring.take_writer_wakeup())
+	{
+		shm_channel_t::signal(channel_->receive_space_event);
+	}
+
+	return bytes_read;
+}
+
+std::uint8_t boost_shm_socket_t::wait_readable()
+{
+	if (!channel_)
+	{
+		return 0;
+	}
+
+	shm::ring_t& ring = channel_->receive_ring;
+
+	// whatever the peer wrote before closing is still delivered
+	if (ring.is_closed())
+	{
+		return !ring.is_empty();
+	}
+
+	if (spin(busy_poll_, [&ring]() { return !ring.is_empty() || ring.is_closed(); }) || !ring.arm_read_wait())
+	{
+		return 1;
+	}
+
+	if (!poll_event(channel_->receive_data_event.native_handle(), socket_.native_handle()))
+	{
+		channel_->close();
+	}
+
+	shm_channel_t::drain(channel_->receive_data_event);
+
+	return 1;
+}
+
+std::uint8_t boost_shm_socket_t::wait_writable()
+{
+	shm::ring_t& ring = channel_->send_ring;
+
+	if (spin(busy_poll_, [&ring]() { return !ring.is_full() || ring.is_closed(); }) || !ring.arm_write_wait())
+	{
+		return 1;
+	}
+
+	if (!poll_event(channel_->send_space_event.native_handle(), socket_.native_handle()))
+	{
+		channel_->close();
+	}
+
+	shm_channel_t::drain(channel_->send_space_event);
+
+	return 1;
+}
+
+awaitable_t<std::uint8_t> boost_shm_socket_t::co_wait_readable(const std::shared_ptr<shm_channel_t> channel)
+{
+	if (!channel)
+	{
+		co_return 0;
+	}
+
+	shm::ring_t& ring = channel->receive_ring;
+
+	if (ring.is_closed())
+	{
+		co_return !ring.is_empty();
+	}
+
+	if (spin(busy_poll_, [&ring]() { return !ring.is_empty() || ring.is_closed(); }) || !ring.arm_read_wait())
+	{
+		co_return 1;
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await channel->receive_data_event.async_wait(descriptor_t::wait_read, boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
+		co_return 0;
+	}
+
+	shm_channel_t::drain(channel->receive_data_event);
+
+	co_return 1;
+}
+
+awaitable_t<std::uint8_t> boost_shm_socket_t::co_wait_writable(const std::shared_ptr<shm_channel_t> channel)
+{
+	shm::ring_t& ring = channel->send_ring;
+
+	if (spin(busy_poll_, [&ring]() { return !ring.is_full() || ring.is_closed(); }) || !ring.arm_write_wait())
+	{
+		co_return 1;
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await channel->send_space_event.async_wait(descriptor_t::wait_read, boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
+		co_return 0;
+	}
+
+	shm_channel_t::drain(channel->send_space_event);
+
+	co_return 1;
+}
+
+void boost_shm_socket_t::spawn(awaitable_t<std::uint8_t> operation, const async_callback_t& handler)
+{
+	boost::asio::co_spawn(executor(), std::move(operation), memory::bind_pool(
+		[handler](const std::exception_ptr&, const std::uint8_t is_valid)
+		{
+			handler(is_valid);
+		})
+	);
+}
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+#include "socket.hpp"
+
+#ifdef __linux__
+#include "shm_ring.hpp"
+
+#include <chrono>
+
+struct shm_channel_t;
+
+// carries the byte stream through a pair of rings in a memfd segment shared with the peer, with eventfds to wake
+// a sleeping end, so a message costs a copy in and a copy out and no system call while the other end is awake
+// a unix domain socket connects the two ends, hands the segment and eventfds over during the handshake and is kept open
+// so each end notices when the other goes away
+class boost_shm_socket_t final : public socket_t
+{
+public:
+	typedef boost::asio::io_context asio_context_t;
+	typedef boost::asio::local::stream_protocol::socket asio_socket_t;
+	typedef boost::asio::local::stream_protocol::endpoint asio_endpoint_t;
+	typedef boost::asio::posix::stream_descriptor descriptor_t;
+
+	static constexpr std::uint64_t default_ring_capacity = 1024 * 1024;
+
+	explicit boost_shm_socket_t(std::shared_ptr<asio_context_t> io_context)
+		:	io_context_(std::move(io_context)),
+			socket_(*io_context_) {}
+
+	explicit boost_shm_socket_t(std::shared_ptr<asio_context_t> io_context, asio_socket_t socket)
+		:	io_context_(std::move(io_context)),
+			socket_(std::move(socket)) {}
+
+	// the host is the path of the listener's unix domain socket and the service is ignored
+	std::uint8_t connect(const std::string_view& host, const std::string_view& service) override;
+	std::uint8_t connect(std::uint32_t ipv4_address, std::uint16_t port) override;
+
+	void close() override;
+
+	// the server creates the segment and sends it to the client, no data can be sent or received before
+	std::uint8_t handshake(handshake_type_t type) override;
+	void async_handshake(handshake_type_t type, const async_callback_t& handler) override;
+
+	std::uint8_t read(void* buffer, std::uint64_t size) override;
+	void async_read(void* buffer, std::uint64_t size, const async_callback_t& handler) override;
+	void async_read_some(void* buffer, std::uint64_t size, const async_size_callback_t& handler) override;
+
+	std::uint8_t write(const void* buffer, std::uint64_t size) override;
+	void async_write(const void* buffer, std::uint64_t size, const async_callback_t& handler) override;
+
+	// the buffers are copied into the ring one after another, only async_gather_write coalesces them first
+	// only one async gather write may be in flight at a time
+	std::uint8_t gather_write(socket_buffers_t buffers) override;
+	void async_gather_write(socket_buffers_t buffers, const async_callback_t& handler) override;
+
+	[[nodiscard]] boost::asio::any_io_executor executor() override;
+
+	awaitable_t<std::uint8_t> co_handshake(handshake_type_t type) override;
+	awaitable_t<std::uint8_t> co_read(void* buffer, std::uint64_t size) override;
+	awaitable_t<std::uint8_t> co_read_some(void* buffer, std::uint64_t size, std::uint64_t& bytes_read) override;
+	awaitable_t<std::uint8_t> co_write(const void* buffer, std::uint64_t size) override;
+	awaitable_t<std::uint8_t> co_gather_write(socket_buffers_t buffers) override;
+
+	// zero, the peer is on the same host and has neither
+	[[nodiscard]] std::uint32_t ipv4_address() override;
+	[[nodiscard]] std::uint16_t port() override;
+
+	// the server's capacity, rounded up to a power of two, is used for both rings, set it before the handshake
+	void set_ring_capacity(std::uint64_t capacity);
+
+	// spins on a ring for up to busy_poll before sleeping on its eventfd, trading a core for wakeup latency
+	void set_busy_poll(std::chrono::nanoseconds busy_poll);
+
+protected:
+	[[nodiscard]] std::uint8_t offer_channel();
+	[[nodiscard]] std::uint8_t accept_channel();
+
+	// wakes both ends' waiters once the control socket reports the peer has gone
+	void watch_peer();
+
+	// a ring operation followed by waking the other end if it is asleep
+	std::uint64_t send(const void* buffer, std::uint64_t size);
+	std::uint64_t receive(void* buffer, std::uint64_t size);
+
+	// return 0 once the channel is closed and, for reads, drained
+	[[nodiscard]] std::uint8_t wait_readable();
+	[[nodiscard]] std::uint8_t wait_writable();
+	awaitable_t<std::uint8_t> co_wait_readable(std::shared_ptr<shm_channel_t> channel);
+	awaitable_t<std::uint8_t> co_wait_writable(std::shared_ptr<shm_channel_t> channel);
+
+	// runs a coroutine on behalf of a callback routine
+	void spawn(awaitable_t<std::uint8_t> operation, const async_callback_t& handler);
+
+	std::shared_ptr<asio_context_t> io_context_;
+	asio_socket_t socket_;
+	std::shared_ptr<shm_channel_t> channel_;
+	std::vector<std::uint8_t> gather_buffer_;
+
+	std::uint64_t ring_capacity_ = default_ring_capacity;
+	std::chrono::nanoseconds busy_poll_ = std::chrono::nanoseconds(0);
+};
+#endif
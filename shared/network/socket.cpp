@@ -1,7 +1,13 @@
 #include "socket.hpp"
+#include "../memory/pool.hpp"
+#include "../logging/logging.hpp"
 
 #include <spdlog/spdlog.h>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 void socket_t::erase(const std::uint64_t size)
 {
 	auto dummy_buffer = std::vector<std::uint8_t>(size);
@@ -26,6 +32,32 @@ void socket_t::async_erase(const std::uint64_t size, const async_callback_t& han
 	);
 }
 
+#ifndef _WIN32
+awaitable_t<std::uint8_t> socket_t::co_send_file(const std::int32_t file_descriptor, const std::uint64_t offset, const std::uint64_t size)
+{
+	std::vector<std::uint8_t> chunk(std::min(size, send_file_chunk_size));
+
+	for (std::uint64_t transferred = 0; transferred < size;)
+	{
+		const ssize_t bytes_read = pread(file_descriptor, chunk.data(), std::min<std::uint64_t>(chunk.size(), size - transferred), static_cast<off_t>(offset + transferred));
+
+		if (bytes_read <= 0 || !co_await co_write(chunk.data(), bytes_read))
+		{
+			co_return 0;
+		}
+
+		transferred += bytes_read;
+	}
+
+	co_return 1;
+}
+
+std::uint8_t socket_t::can_send_file_directly() const
+{
+	return 0;
+}
+#endif
+
 std::uint8_t boost_tcp_socket_t::connect(const std::string_view& host, const std::string_view& service)
 {
 	const std::optional<resolver_t::results_type> endpoints = resolve_host(host, service);
@@ -56,21 +88,56 @@ std::uint8_t boost_tcp_socket_t::connect(const std::uint32_t ipv4_address, const
 	return !error_code.failed();
 }
 
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_connect(const resolver_t::results_type endpoints)
+{
+	boost::system::error_code error_code = { };
+
+	co_await boost::asio::async_connect(stream_->lowest_layer(), endpoints, boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+void boost_tcp_socket_t::set_keep_alive(const std::uint8_t is_enabled)
+{
+	boost::system::error_code error_code = { };
+
+	stream_->lowest_layer().set_option(boost::asio::socket_base::keep_alive(is_enabled), error_code);
+}
+
 void boost_tcp_socket_t::close()
 {
-	//stream_->shutdown();
+	SSL* const ssl = stream_->native_handle();
+
+	// marks the session as cleanly closed so it stays resumable, without blocking on the peer's close_notify
+	if (SSL_is_init_finished(ssl) && SSL_shutdown(ssl) < 0)
+	{
+		ERR_clear_error();
+	}
 
 	auto& lowest_layer = stream_->lowest_layer();
 
-	lowest_layer.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
-	lowest_layer.close();
+	// the peer may already have gone, which is not worth throwing over
+	boost::system::error_code error_code = { };
+
+	lowest_layer.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error_code);
+	lowest_layer.close(error_code);
 }
 
 std::uint8_t boost_tcp_socket_t::handshake(const handshake_type_t type)
 {
+	if (is_kernel_tls_)
+	{
+		return direct_handshake(type);
+	}
+
 	boost::system::error_code error_code = { };
 
-	const asio_handshake_type_t asio_type = asio_handshake_type(type);
+	const asio_handshake_type_t asio_type = prepare_handshake(type);
 
 	stream_->handshake(asio_type, error_code);
 
@@ -79,25 +146,37 @@ std::uint8_t boost_tcp_socket_t::handshake(const handshake_type_t type)
 
 void boost_tcp_socket_t::async_handshake(const handshake_type_t type, const async_callback_t& handler)
 {
-	const asio_handshake_type_t asio_type = asio_handshake_type(type);
+	if (is_kernel_tls_)
+	{
+		spawn_direct(co_direct_handshake(type), handler);
+
+		return;
+	}
+
+	const asio_handshake_type_t asio_type = prepare_handshake(type);
 
 	stream_->async_handshake(asio_type,
-		[handler](const boost::system::error_code& error_code)
+		memory::bind_pool([handler](const boost::system::error_code& error_code)
 		{
 			const std::uint8_t is_valid = !error_code;
 
 			if (!is_valid)
 			{
-				spdlog::error(error_code.what());
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
 			}
 
 			handler(is_valid);
-		}
+		})
 	);
 }
 
 std::uint8_t boost_tcp_socket_t::read(void* const buffer, const std::uint64_t size)
 {
+	if (is_kernel_tls_)
+	{
+		return direct_read(buffer, size);
+	}
+
 	boost::system::error_code error_code = { };
 
 	boost::asio::read(*stream_, boost::asio::buffer(buffer, size), error_code);
@@ -107,23 +186,72 @@ std::uint8_t boost_tcp_socket_t::read(void* const buffer, const std::uint64_t si
 
 void boost_tcp_socket_t::async_read(void* const buffer, const std::uint64_t size, const async_callback_t& handler)
 {
+	if (is_kernel_tls_)
+	{
+		spawn_direct(co_direct_read(buffer, size), handler);
+
+		return;
+	}
+
 	boost::asio::async_read(*stream_, boost::asio::buffer(buffer, size),
-		[handler](const boost::system::error_code& error_code, const std::uint64_t)
+		memory::bind_pool([handler](const boost::system::error_code& error_code, const std::uint64_t)
 		{
 			const std::uint8_t is_valid = !error_code;
 
 			if (!is_valid)
 			{
-				spdlog::error(error_code.what());
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
 			}
 
 			handler(is_valid);
-		}
+		})
+	);
+}
+
+void boost_tcp_socket_t::async_read_some(void* const buffer, const std::uint64_t size, const async_size_callback_t& handler)
+{
+	if (is_kernel_tls_)
+	{
+		boost::asio::co_spawn(executor(),
+			[this, buffer, size]() -> awaitable_t<std::pair<std::uint8_t, std::uint64_t>>
+			{
+				std::uint64_t bytes_read = 0;
+
+				const std::uint8_t is_valid = co_await co_direct_read_some(buffer, size, bytes_read);
+
+				co_return std::pair(is_valid, bytes_read);
+			},
+			memory::bind_pool([handler](const std::exception_ptr&, const std::pair<std::uint8_t, std::uint64_t> result)
+			{
+				handler(result.first, result.second);
+			})
+		);
+
+		return;
+	}
+
+	stream_->async_read_some(boost::asio::buffer(buffer, size),
+		memory::bind_pool([handler](const boost::system::error_code& error_code, const std::uint64_t bytes_read)
+		{
+			const std::uint8_t is_valid = !error_code;
+
+			if (!is_valid)
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+			}
+
+			handler(is_valid, bytes_read);
+		})
 	);
 }
 
 std::uint8_t boost_tcp_socket_t::write(const void* const buffer, const std::uint64_t size)
 {
+	if (is_kernel_tls_)
+	{
+		return direct_write(buffer, size);
+	}
+
 	boost::system::error_code error_code = { };
 
 	boost::asio::write(*stream_, boost::asio::buffer(buffer, size), error_code);
@@ -133,21 +261,198 @@ std::uint8_t boost_tcp_socket_t::write(const void* const buffer, const std::uint
 
 void boost_tcp_socket_t::async_write(const void* const buffer, const std::uint64_t size, const async_callback_t& handler)
 {
+	if (is_kernel_tls_)
+	{
+		spawn_direct(co_direct_write(buffer, size), handler);
+
+		return;
+	}
+
 	boost::asio::async_write(*stream_, boost::asio::buffer(buffer, size),
-		[handler](const boost::system::error_code& error_code, const std::uint64_t)
+		memory::bind_pool([handler](const boost::system::error_code& error_code, const std::uint64_t)
 		{
 			const std::uint8_t is_valid = !error_code;
 
 			if (!is_valid)
 			{
-				spdlog::error(error_code.what());
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
 			}
 
 			handler(is_valid);
-		}
+		})
+	);
+}
+
+std::uint8_t boost_tcp_socket_t::gather_write(const socket_buffers_t buffers)
+{
+	if (is_kernel_tls_)
+	{
+		const boost::asio::const_buffer buffer = coalesce(buffers);
+
+		const std::uint8_t is_valid = direct_write(buffer.data(), buffer.size());
+
+		release_gather_buffer(gather_buffer_);
+
+		return is_valid;
+	}
+
+	if (buffers.size() == 1)
+	{
+		return write(buffers.front().data, buffers.front().size);
+	}
+
+	boost::system::error_code error_code = { };
+
+	boost::asio::write(*stream_, coalesce(buffers), error_code);
+
+	release_gather_buffer(gather_buffer_);
+
+	return !error_code;
+}
+
+void boost_tcp_socket_t::async_gather_write(const socket_buffers_t buffers, const async_callback_t& handler)
+{
+	if (is_kernel_tls_)
+	{
+		const boost::asio::const_buffer buffer = coalesce(buffers);
+
+		spawn_direct(co_direct_write(buffer.data(), buffer.size()),
+			[this, handler](const std::uint8_t is_valid)
+			{
+				release_gather_buffer(gather_buffer_);
+
+				handler(is_valid);
+			}
+		);
+
+		return;
+	}
+
+	boost::asio::async_write(*stream_, coalesce(buffers),
+		memory::bind_pool([this, handler](const boost::system::error_code& error_code, const std::uint64_t)
+		{
+			const std::uint8_t is_valid = !error_code;
+
+			if (!is_valid)
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+			}
+
+			release_gather_buffer(gather_buffer_);
+
+			handler(is_valid);
+		})
 	);
 }
 
+boost::asio::any_io_executor boost_tcp_socket_t::executor()
+{
+	return stream_->get_executor();
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_handshake(const handshake_type_t type)
+{
+	if (is_kernel_tls_)
+	{
+		co_return co_await co_direct_handshake(type);
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await stream_->async_handshake(prepare_handshake(type), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_read(void* const buffer, const std::uint64_t size)
+{
+	if (is_kernel_tls_)
+	{
+		co_return co_await co_direct_read(buffer, size);
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await boost::asio::async_read(*stream_, boost::asio::buffer(buffer, size), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_read_some(void* const buffer, const std::uint64_t size, std::uint64_t& bytes_read)
+{
+	if (is_kernel_tls_)
+	{
+		co_return co_await co_direct_read_some(buffer, size, bytes_read);
+	}
+
+	boost::system::error_code error_code = { };
+
+	bytes_read = co_await stream_->async_read_some(boost::asio::buffer(buffer, size), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_write(const void* const buffer, const std::uint64_t size)
+{
+	if (is_kernel_tls_)
+	{
+		co_return co_await co_direct_write(buffer, size);
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await boost::asio::async_write(*stream_, boost::asio::buffer(buffer, size), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
+awaitable_t<std::uint8_t> boost_tcp_socket_t::co_gather_write(const socket_buffers_t buffers)
+{
+	if (is_kernel_tls_)
+	{
+		const boost::asio::const_buffer buffer = coalesce(buffers);
+
+		const std::uint8_t is_valid = co_await co_direct_write(buffer.data(), buffer.size());
+
+		release_gather_buffer(gather_buffer_);
+
+		co_return is_valid;
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await boost::asio::async_write(*stream_, coalesce(buffers), boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	release_gather_buffer(gather_buffer_);
+
+	if (error_code)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+	}
+
+	co_return !error_code;
+}
+
 std::uint32_t boost_tcp_socket_t::ipv4_address()
 {
 	const asio_endpoint_t remote_endpoint_ = remote_endpoint();
@@ -169,10 +474,12 @@ std::optional<boost_tcp_socket_t::resolver_t::results_type> boost_tcp_socket_t::
 	boost::system::error_code error_code = { };
 
 	resolver_t resolver(*io_context_);
-	resolver_t::results_type endpoints = resolver.resolve(host, service);
+	resolver_t::results_type endpoints = resolver.resolve(host, service, error_code);
 
 	if (error_code)
 	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, error_code.what());
+
 		return std::nullopt;
 	}
 
@@ -193,6 +500,35 @@ boost_tcp_socket_t::asio_endpoint_t boost_tcp_socket_t::local_endpoint() const
 	return lowest_layer.local_endpoint();
 }
 
+boost::asio::const_buffer boost_tcp_socket_t::coalesce(const socket_buffers_t buffers)
+{
+	gather_buffer_.clear();
+
+	for (const socket_buffer_t& buffer : buffers)
+	{
+		const auto buffer_begin = static_cast<const std::uint8_t*>(buffer.data);
+
+		gather_buffer_.insert(gather_buffer_.end(), buffer_begin, buffer_begin + buffer.size);
+	}
+
+	return boost::asio::buffer(gather_buffer_);
+}
+
+std::uint8_t boost_tcp_socket_t::is_session_resumed() const
+{
+	return SSL_session_reused(stream_->native_handle()) == 1;
+}
+
+boost_tcp_socket_t::asio_handshake_type_t boost_tcp_socket_t::prepare_handshake(const handshake_type_t type)
+{
+	if (type == handshake_type_t::client)
+	{
+		ssl_context_->offer_session(stream_->native_handle());
+	}
+
+	return asio_handshake_type(type);
+}
+
 boost_tcp_socket_t::asio_handshake_type_t boost_tcp_socket_t::asio_handshake_type(const handshake_type_t type)
 {
 	return type == handshake_type_t::client ? asio_handshake_type_t::client : asio_handshake_type_t::server;
@@ -3,7 +3,34 @@
 
 #include "ssl.hpp"
 
+#include <span>
+#include <vector>
+
 typedef std::function<void(std::uint8_t is_valid)> async_callback_t;
+typedef std::function<void(std::uint8_t is_valid, std::uint64_t size)> async_size_callback_t;
+
+struct socket_buffer_t
+{
+	const void* data;
+	std::uint64_t size;
+};
+
+typedef std::span<const socket_buffer_t> socket_buffers_t;
+
+// streams which cannot take a gather write have it coalesced into one buffer, which keeps the capacity of the largest
+// write it ever held, so it is freed once a write larger than this has completed
+constexpr std::uint64_t max_retained_gather_size = 64 * 1024;
+
+inline void release_gather_buffer(std::vector<std::uint8_t>& gather_buffer)
+{
+	if (gather_buffer.capacity() > max_retained_gather_size)
+	{
+		gather_buffer = { };
+	}
+}
+
+template <class t>
+using awaitable_t = boost::asio::awaitable<t>;
 
 class socket_t
 {
@@ -30,9 +57,38 @@ public:
 	virtual std::uint8_t read(void* buffer, std::uint64_t size) = 0;
 	virtual void async_read(void* buffer, std::uint64_t size, const async_callback_t& handler) = 0;
 
+	// completes as soon as any data is available, with up to size bytes read
+	virtual void async_read_some(void* buffer, std::uint64_t size, const async_size_callback_t& handler) = 0;
+
 	virtual std::uint8_t write(const void* buffer, std::uint64_t size) = 0;
 	virtual void async_write(const void* buffer, std::uint64_t size, const async_callback_t& handler) = 0;
 
+	// writes every buffer in one operation, async_gather_write copies the buffers before it returns
+	virtual std::uint8_t gather_write(socket_buffers_t buffers) = 0;
+	virtual void async_gather_write(socket_buffers_t buffers, const async_callback_t& handler) = 0;
+
+	// awaitable counterparts of the async routines, they must be awaited on the socket's executor
+	// and need no std::function or shared buffer per operation
+	[[nodiscard]] virtual boost::asio::any_io_executor executor() = 0;
+
+	virtual awaitable_t<std::uint8_t> co_handshake(handshake_type_t type) = 0;
+	virtual awaitable_t<std::uint8_t> co_read(void* buffer, std::uint64_t size) = 0;
+	virtual awaitable_t<std::uint8_t> co_read_some(void* buffer, std::uint64_t size, std::uint64_t& bytes_read) = 0;
+	virtual awaitable_t<std::uint8_t> co_write(const void* buffer, std::uint64_t size) = 0;
+	virtual awaitable_t<std::uint8_t> co_gather_write(socket_buffers_t buffers) = 0;
+
+#ifndef _WIN32
+	// large enough to fill many tls records per write, small enough that a file of any size holds one chunk at a time
+	static constexpr std::uint64_t send_file_chunk_size = 256 * 1024;
+
+	// sends part of a file without reading all of it into memory, sockets the kernel can send a file through directly
+	// override this to do so, the rest read and write it in chunks
+	virtual awaitable_t<std::uint8_t> co_send_file(std::int32_t file_descriptor, std::uint64_t offset, std::uint64_t size);
+
+	// the file goes from the page cache to the socket without passing through user space
+	[[nodiscard]] virtual std::uint8_t can_send_file_directly() const;
+#endif
+
 	[[nodiscard]] virtual std::uint32_t ipv4_address() = 0;
 	[[nodiscard]] virtual std::uint16_t port() = 0;
 
@@ -89,6 +145,12 @@ public:
 	std::uint8_t connect(const std::string_view& host, const std::string_view& service) override;
 	std::uint8_t connect(std::uint32_t ipv4_address, std::uint16_t port) override;
 
+	// tries each resolved endpoint in turn, so a caller can resolve once and reuse the results for every connection
+	awaitable_t<std::uint8_t> co_connect(resolver_t::results_type endpoints);
+
+	// the kernel probes an idle connection and fails it once the peer stops answering
+	void set_keep_alive(std::uint8_t is_enabled);
+
 	void close() override;
 
 	std::uint8_t handshake(handshake_type_t type) override;
@@ -96,22 +158,95 @@ public:
 
 	std::uint8_t read(void* buffer, std::uint64_t size) override;
 	void async_read(void* buffer, std::uint64_t size, const async_callback_t& handler) override;
+	void async_read_some(void* buffer, std::uint64_t size, const async_size_callback_t& handler) override;
 
 	std::uint8_t write(const void* buffer, std::uint64_t size) override;
 	void async_write(const void* buffer, std::uint64_t size, const async_callback_t& handler) override;
 
+	// tls emits one record per write call, so the buffers are coalesced before being written
+	// only one async gather write may be in flight at a time
+	std::uint8_t gather_write(socket_buffers_t buffers) override;
+	void async_gather_write(socket_buffers_t buffers, const async_callback_t& handler) override;
+
+	[[nodiscard]] boost::asio::any_io_executor executor() override;
+
+	awaitable_t<std::uint8_t> co_handshake(handshake_type_t type) override;
+	awaitable_t<std::uint8_t> co_read(void* buffer, std::uint64_t size) override;
+	awaitable_t<std::uint8_t> co_read_some(void* buffer, std::uint64_t size, std::uint64_t& bytes_read) override;
+	awaitable_t<std::uint8_t> co_write(const void* buffer, std::uint64_t size) override;
+	awaitable_t<std::uint8_t> co_gather_write(socket_buffers_t buffers) override;
+
 	[[nodiscard]] std::uint32_t ipv4_address() override;
 	[[nodiscard]] std::uint16_t port() override;
 
+	// the last handshake resumed a cached or ticketed session instead of running in full
+	[[nodiscard]] std::uint8_t is_session_resumed() const;
+
+	enum class tls_offload_t : std::uint8_t
+	{
+		none,
+		send,
+		receive,
+		send_and_receive
+	};
+
+	// opts in before the handshake: openssl then runs on the socket itself instead of through the asio stream,
+	// so it can hand the record layer to the kernel where kernel tls is available and stays in user space where it is not
+	void enable_kernel_tls();
+
+	// which directions the kernel encrypts, none until a kernel tls handshake has completed
+	[[nodiscard]] tls_offload_t tls_offload() const;
+
+#ifndef _WIN32
+	// with sends offloaded the file goes from the page cache to the socket without a copy through user space,
+	// otherwise it is read in chunks and written like any other buffer
+	std::uint8_t send_file(std::int32_t file_descriptor, std::uint64_t offset, std::uint64_t size);
+	awaitable_t<std::uint8_t> co_send_file(std::int32_t file_descriptor, std::uint64_t offset, std::uint64_t size) override;
+
+	// once the kernel encrypts sends
+	[[nodiscard]] std::uint8_t can_send_file_directly() const override;
+#endif
+
 protected:
 	[[nodiscard]] std::optional<resolver_t::results_type> resolve_host(const std::string_view& host, const std::string_view& service) const;
 	[[nodiscard]] asio_endpoint_t remote_endpoint() const;
 	[[nodiscard]] asio_endpoint_t local_endpoint() const;
 
+	[[nodiscard]] boost::asio::const_buffer coalesce(socket_buffers_t buffers);
+
+	// a client offers the session its ssl context last stored
+	[[nodiscard]] asio_handshake_type_t prepare_handshake(handshake_type_t type);
 	static asio_handshake_type_t asio_handshake_type(handshake_type_t type);
 
+	// kernel tls mode, implemented in kernel_tls.cpp, each operation returns 1 once it has completed
+	// and otherwise the result of the openssl call which could not, which the runners wait on
+	template <class operation_t>
+	std::uint8_t run_direct(operation_t& operation);
+
+	template <class operation_t>
+	awaitable_t<std::uint8_t> co_run_direct(operation_t operation);
+
+	// prepare_handshake's counterpart for the direct handshakes, which also hands openssl the socket
+	void prepare_kernel_tls(handshake_type_t type);
+
+	std::uint8_t direct_handshake(handshake_type_t type);
+	awaitable_t<std::uint8_t> co_direct_handshake(handshake_type_t type);
+	std::uint8_t direct_read(void* buffer, std::uint64_t size);
+	awaitable_t<std::uint8_t> co_direct_read(void* buffer, std::uint64_t size);
+	awaitable_t<std::uint8_t> co_direct_read_some(void* buffer, std::uint64_t size, std::uint64_t& bytes_read);
+	std::uint8_t direct_write(const void* buffer, std::uint64_t size);
+	awaitable_t<std::uint8_t> co_direct_write(const void* buffer, std::uint64_t size);
+
+	// runs a kernel tls coroutine on behalf of a callback routine
+	void spawn_direct(awaitable_t<std::uint8_t> operation, const async_callback_t& handler);
+
+	void report_tls_offload() const;
+
 	std::shared_ptr<asio_context_t> io_context_;
 	std::shared_ptr<boost_ssl_context_t> ssl_context_;
 	std::unique_ptr<asio_stream_t> stream_;
+	std::vector<std::uint8_t> gather_buffer_;
+
+	std::uint8_t is_kernel_tls_ = 0;
 };
 
@@ -1,7 +1,175 @@
 #include "ssl.hpp"
 
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+
 #include <spdlog/spdlog.h>
 
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <optional>
+
+struct session_ticket_key_t
+{
+	std::array<std::uint8_t, 16> name;
+	std::array<std::uint8_t, 32> aes_key;
+	std::array<std::uint8_t, 32> hmac_key;
+	std::chrono::steady_clock::time_point created;
+};
+
+struct session_resumption_t
+{
+	~session_resumption_t()
+	{
+		if (last_session != nullptr)
+		{
+			SSL_SESSION_free(last_session);
+		}
+	}
+
+	std::mutex mutex;
+
+	// the previous key only opens tickets, so those sealed shortly before a rotation stay valid
+	std::optional<session_ticket_key_t> ticket_key;
+	std::optional<session_ticket_key_t> previous_ticket_key;
+	std::chrono::seconds ticket_key_lifetime = std::chrono::seconds(0);
+
+	SSL_SESSION* last_session = nullptr;
+};
+
+// openssl's default, restored when resumption is enabled again after being disabled
+static constexpr std::uint64_t default_session_ticket_count = 2;
+
+// resumption is refused on contexts which verify their peer unless a session id context is set
+static constexpr std::array<std::uint8_t, 8> session_id_context = { 'S', 'o', 'c', 'k', 'e', 't', 'S', 'L' };
+
+static std::int32_t session_resumption_index()
+{
+	static const std::int32_t index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+
+	return index;
+}
+
+static session_resumption_t& session_resumption(SSL* const ssl)
+{
+	return *static_cast<session_resumption_t*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), session_resumption_index()));
+}
+
+// expects the session resumption mutex to be held
+static void rotate_ticket_key(session_resumption_t& resumption)
+{
+	session_ticket_key_t ticket_key = { };
+
+	if (RAND_bytes(ticket_key.name.data(), ticket_key.name.size()) != 1
+		|| RAND_bytes(ticket_key.aes_key.data(), ticket_key.aes_key.size()) != 1
+		|| RAND_bytes(ticket_key.hmac_key.data(), ticket_key.hmac_key.size()) != 1)
+	{
+		spdlog::error("failed to generate a session ticket key");
+
+		return;
+	}
+
+	ticket_key.created = std::chrono::steady_clock::now();
+
+	resumption.previous_ticket_key = std::move(resumption.ticket_key);
+	resumption.ticket_key = ticket_key;
+}
+
+static std::uint8_t use_ticket_mac_key(EVP_MAC_CTX* const mac_context, session_ticket_key_t& ticket_key)
+{
+	const std::array<OSSL_PARAM, 3> parameters = {
+		OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, ticket_key.hmac_key.data(), ticket_key.hmac_key.size()),
+		OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+		OSSL_PARAM_construct_end()
+	};
+
+	return EVP_MAC_CTX_set_params(mac_context, parameters.data()) == 1;
+}
+
+// seals new tickets with the current key and opens tickets sealed with the current or previous key,
+// returning 2 asks openssl to hand out a new ticket under the current key
+static std::int32_t session_ticket_key_callback(SSL* const ssl, std::uint8_t* const key_name, std::uint8_t* const iv, EVP_CIPHER_CTX* const cipher_context, EVP_MAC_CTX* const mac_context, const std::int32_t is_encrypting)
+{
+	session_resumption_t& resumption = session_resumption(ssl);
+
+	const std::lock_guard lock(resumption.mutex);
+
+	if (is_encrypting)
+	{
+		if (!resumption.ticket_key.has_value() || std::chrono::steady_clock::now() - resumption.ticket_key->created >= resumption.ticket_key_lifetime)
+		{
+			rotate_ticket_key(resumption);
+		}
+
+		if (!resumption.ticket_key.has_value())
+		{
+			return 0;
+		}
+
+		session_ticket_key_t& ticket_key = *resumption.ticket_key;
+
+		std::memcpy(key_name, ticket_key.name.data(), ticket_key.name.size());
+
+		if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(EVP_aes_256_cbc())) != 1
+			|| EVP_EncryptInit_ex(cipher_context, EVP_aes_256_cbc(), nullptr, ticket_key.aes_key.data(), iv) != 1
+			|| !use_ticket_mac_key(mac_context, ticket_key))
+		{
+			return -1;
+		}
+
+		return 1;
+	}
+
+	for (std::optional<session_ticket_key_t>* const ticket_key : { &resumption.ticket_key, &resumption.previous_ticket_key })
+	{
+		if (!ticket_key->has_value() || std::memcmp(key_name, (*ticket_key)->name.data(), (*ticket_key)->name.size()) != 0)
+		{
+			continue;
+		}
+
+		if (EVP_DecryptInit_ex(cipher_context, EVP_aes_256_cbc(), nullptr, (*ticket_key)->aes_key.data(), iv) != 1
+			|| !use_ticket_mac_key(mac_context, **ticket_key))
+		{
+			return -1;
+		}
+
+		// tls 1.3 clients use each ticket once, so every resumption needs a fresh ticket as well
+		return ticket_key == &resumption.ticket_key && SSL_version(ssl) < TLS1_3_VERSION ? 1 : 2;
+	}
+
+	// sealed with a key which has been rotated out, so a full handshake follows
+	return 0;
+}
+
+// keeps the reference openssl hands over, so the session can be offered on the next handshake
+static std::int32_t store_last_session(SSL* const ssl, SSL_SESSION* const session)
+{
+	session_resumption_t& resumption = session_resumption(ssl);
+
+	const std::lock_guard lock(resumption.mutex);
+
+	if (resumption.last_session != nullptr)
+	{
+		SSL_SESSION_free(resumption.last_session);
+	}
+
+	resumption.last_session = session;
+
+	return 1;
+}
+
+boost_ssl_context_t::boost_ssl_context_t(const ssl_method_t ssl_method)
+		:	native_handle_(std::make_unique<asio_ssl_t>(ssl_method)),
+			session_resumption_(std::make_unique<session_resumption_t>())
+{
+	SSL_CTX_set_ex_data(native_handle_->native_handle(), session_resumption_index(), session_resumption_.get());
+}
+
+boost_ssl_context_t::~boost_ssl_context_t() = default;
+
 void boost_ssl_context_t::disable_peer_verification()
 {
 	native_handle_->set_verify_mode(boost::asio::ssl::verify_none);
@@ -60,6 +228,103 @@ void boost_ssl_context_t::use_private_key(const std::span<std::uint8_t> buffer,
 	native_handle_->use_private_key(boost::asio::buffer(buffer), ssl_ff);
 }
 
+void boost_ssl_context_t::set_protocol_versions(const protocol_version_t minimum_version, const protocol_version_t maximum_version)
+{
+	SSL_CTX* const context = native_handle_->native_handle();
+
+	throw_on_failure(SSL_CTX_set_min_proto_version(context, openssl_protocol_version(minimum_version)), "set_protocol_versions");
+	throw_on_failure(SSL_CTX_set_max_proto_version(context, openssl_protocol_version(maximum_version)), "set_protocol_versions");
+}
+
+void boost_ssl_context_t::set_cipher_list(const std::string& cipher_list)
+{
+	throw_on_failure(SSL_CTX_set_cipher_list(native_handle_->native_handle(), cipher_list.c_str()), "set_cipher_list");
+}
+
+void boost_ssl_context_t::set_cipher_suites(const std::string& cipher_suites)
+{
+	throw_on_failure(SSL_CTX_set_ciphersuites(native_handle_->native_handle(), cipher_suites.c_str()), "set_cipher_suites");
+}
+
+void boost_ssl_context_t::set_groups(const std::string& groups)
+{
+	throw_on_failure(SSL_CTX_set1_groups_list(native_handle_->native_handle(), groups.c_str()), "set_groups");
+}
+
+void boost_ssl_context_t::enable_session_cache(const std::uint64_t cache_size, const std::chrono::seconds timeout)
+{
+	SSL_CTX* const context = native_handle_->native_handle();
+
+	SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+	SSL_CTX_sess_set_cache_size(context, static_cast<long>(cache_size));
+	SSL_CTX_set_timeout(context, static_cast<long>(timeout.count()));
+	SSL_CTX_set_session_id_context(context, session_id_context.data(), session_id_context.size());
+	SSL_CTX_set_num_tickets(context, default_session_ticket_count);
+}
+
+void boost_ssl_context_t::enable_session_tickets(const std::chrono::seconds key_lifetime)
+{
+	SSL_CTX* const context = native_handle_->native_handle();
+
+	{
+		const std::lock_guard lock(session_resumption_->mutex);
+
+		session_resumption_->ticket_key_lifetime = key_lifetime;
+
+		rotate_ticket_key(*session_resumption_);
+	}
+
+	SSL_CTX_clear_options(context, SSL_OP_NO_TICKET);
+	SSL_CTX_set_tlsext_ticket_key_evp_cb(context, session_ticket_key_callback);
+	SSL_CTX_set_session_id_context(context, session_id_context.data(), session_id_context.size());
+	SSL_CTX_set_num_tickets(context, default_session_ticket_count);
+}
+
+void boost_ssl_context_t::rotate_session_ticket_key()
+{
+	const std::lock_guard lock(session_resumption_->mutex);
+
+	rotate_ticket_key(*session_resumption_);
+}
+
+void boost_ssl_context_t::disable_session_resumption()
+{
+	SSL_CTX* const context = native_handle_->native_handle();
+
+	SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_OFF);
+	SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+	SSL_CTX_set_num_tickets(context, 0);
+
+	const std::lock_guard lock(session_resumption_->mutex);
+
+	if (session_resumption_->last_session != nullptr)
+	{
+		SSL_SESSION_free(session_resumption_->last_session);
+
+		session_resumption_->last_session = nullptr;
+	}
+}
+
+void boost_ssl_context_t::enable_session_reuse()
+{
+	SSL_CTX* const context = native_handle_->native_handle();
+
+	// openssl's internal cache is keyed for servers, the client only needs the last session
+	SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(context, store_last_session);
+	SSL_CTX_clear_options(context, SSL_OP_NO_TICKET);
+}
+
+void boost_ssl_context_t::offer_session(SSL* const ssl) const
+{
+	const std::lock_guard lock(session_resumption_->mutex);
+
+	if (session_resumption_->last_session != nullptr && SSL_SESSION_is_resumable(session_resumption_->last_session))
+	{
+		SSL_set_session(ssl, session_resumption_->last_session);
+	}
+}
+
 void boost_ssl_context_t::set_options(const ssl_options_t options)
 {
 	native_handle_->set_options(options);
@@ -75,6 +340,21 @@ boost_ssl_context_t::asio_ssl_t& boost_ssl_context_t::native_handle() const
 	return *native_handle_;
 }
 
+std::int32_t boost_ssl_context_t::openssl_protocol_version(const protocol_version_t protocol_version)
+{
+	return protocol_version == protocol_version_t::tls_1_3 ? TLS1_3_VERSION : TLS1_2_VERSION;
+}
+
+void boost_ssl_context_t::throw_on_failure(const std::int32_t result, const char* const location)
+{
+	if (result != 1)
+	{
+		const boost::system::error_code error_code(static_cast<std::int32_t>(ERR_get_error()), boost::asio::error::get_ssl_category());
+
+		boost::asio::detail::throw_error(error_code, location);
+	}
+}
+
 boost_ssl_context_t::ssl_file_format_t boost_ssl_context_t::ssl_file_format(const crypto_file_format_t file_format)
 {
 	return file_format == crypto_file_format_t::asn1 ? ssl_file_format_t::asn1 : ssl_file_format_t::pem;;
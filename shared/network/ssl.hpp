@@ -1,6 +1,7 @@
 #pragma once
 #include <boost/asio/ssl.hpp>
 
+#include <chrono>
 #include <span>
 
 class ssl_context_t
@@ -12,6 +13,12 @@ public:
 		pem
 	};
 
+	enum class protocol_version_t : std::uint8_t
+	{
+		tls_1_2,
+		tls_1_3
+	};
+
 	ssl_context_t() = default;
 	virtual ~ssl_context_t() = default;
 
@@ -29,8 +36,34 @@ public:
 
 	virtual void use_private_key(const std::string& path_to_key, crypto_file_format_t file_format) = 0;
 	virtual void use_private_key(std::span<std::uint8_t> buffer, crypto_file_format_t file_format) = 0;
+
+	// only takes effect on contexts created with a version flexible method such as tls_server or tls_client
+	virtual void set_protocol_versions(protocol_version_t minimum_version, protocol_version_t maximum_version) = 0;
+
+	// openssl cipher strings, cipher_list covers tls 1.2 while cipher_suites covers tls 1.3
+	virtual void set_cipher_list(const std::string& cipher_list) = 0;
+	virtual void set_cipher_suites(const std::string& cipher_suites) = 0;
+
+	// ecdh groups in order of preference, such as "X25519:P-256"
+	virtual void set_groups(const std::string& groups) = 0;
+
+	// server side resumption, sessions are kept for timeout in a cache of up to cache_size entries
+	virtual void enable_session_cache(std::uint64_t cache_size, std::chrono::seconds timeout) = 0;
+
+	// server side resumption without server state, the ticket key is rotated every key_lifetime
+	// and tickets sealed with the previous key are still accepted and renewed
+	virtual void enable_session_tickets(std::chrono::seconds key_lifetime) = 0;
+	virtual void rotate_session_ticket_key() = 0;
+
+	virtual void disable_session_resumption() = 0;
+
+	// client side resumption, the last session a server handed out is offered by the next handshake
+	virtual void enable_session_reuse() = 0;
 };
 
+// holds the ticket keys and the client's last session, defined in ssl.cpp
+struct session_resumption_t;
+
 class boost_ssl_context_t final : public ssl_context_t
 {
 public:
@@ -41,8 +74,9 @@ public:
 
 	boost_ssl_context_t() = delete;
 	
-	explicit boost_ssl_context_t(const ssl_method_t ssl_method)
-			:	native_handle_(std::make_unique<asio_ssl_t>(ssl_method)) { }
+	explicit boost_ssl_context_t(ssl_method_t ssl_method);
+
+	~boost_ssl_context_t() override;
 
 	void disable_peer_verification() override;
 	void require_peer_verification() override;
@@ -59,6 +93,23 @@ public:
 	void use_private_key(const std::string& path_to_key, crypto_file_format_t file_format) override;
 	void use_private_key(std::span<std::uint8_t> buffer, crypto_file_format_t file_format) override;
 
+	void set_protocol_versions(protocol_version_t minimum_version, protocol_version_t maximum_version) override;
+
+	void set_cipher_list(const std::string& cipher_list) override;
+	void set_cipher_suites(const std::string& cipher_suites) override;
+
+	void set_groups(const std::string& groups) override;
+
+	void enable_session_cache(std::uint64_t cache_size, std::chrono::seconds timeout) override;
+	void enable_session_tickets(std::chrono::seconds key_lifetime) override;
+	void rotate_session_ticket_key() override;
+	void disable_session_resumption() override;
+
+	void enable_session_reuse() override;
+
+	// called on a client stream before it handshakes
+	void offer_session(SSL* ssl) const;
+
 	void set_options(ssl_options_t options);
 	void clear_options(ssl_options_t options);
 
@@ -66,6 +117,11 @@ public:
 
 protected:
 	static ssl_file_format_t ssl_file_format(crypto_file_format_t file_format);
+	static std::int32_t openssl_protocol_version(protocol_version_t protocol_version);
+
+	// throws like asio's own context routines when openssl rejects a setting
+	static void throw_on_failure(std::int32_t result, const char* location);
 
 	std::unique_ptr<asio_ssl_t> native_handle_;
+	std::unique_ptr<session_resumption_t> session_resumption_;
 };
@@ -0,0 +1,73 @@
+#pragma once
+#include "request_def.hpp"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace request
+{
+	// hands out correlation ids and matches each response back to whatever is waiting on it
+	template <class pending_t>
+	class correlation_table_t
+	{
+	public:
+		correlation_id_t add(pending_t pending)
+		{
+			const correlation_id_t correlation_id = next_correlation_id_++;
+
+			pending_.emplace(correlation_id, std::move(pending));
+
+			return correlation_id;
+		}
+
+		std::optional<pending_t> take(const correlation_id_t correlation_id)
+		{
+			const auto entry = pending_.find(correlation_id);
+
+			if (entry == pending_.end())
+			{
+				return std::nullopt;
+			}
+
+			std::optional<pending_t> pending = std::move(entry->second);
+
+			pending_.erase(entry);
+
+			return pending;
+		}
+
+		// null if nothing is waiting on the id, otherwise valid until the entry is taken
+		pending_t* find(const correlation_id_t correlation_id)
+		{
+			const auto entry = pending_.find(correlation_id);
+
+			return entry == pending_.end() ? nullptr : &entry->second;
+		}
+
+		std::vector<pending_t> take_all()
+		{
+			std::vector<pending_t> pending;
+
+			pending.reserve(pending_.size());
+
+			for (auto& [correlation_id, entry] : pending_)
+			{
+				pending.push_back(std::move(entry));
+			}
+
+			pending_.clear();
+
+			return pending;
+		}
+
+		[[nodiscard]] std::uint64_t size() const
+		{
+			return pending_.size();
+		}
+
+	protected:
+		correlation_id_t next_correlation_id_ = 1;
+		std::unordered_map<correlation_id_t, pending_t> pending_;
+	};
+}
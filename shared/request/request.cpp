@@ -5,12 +5,21 @@
 #include <schema/request_generated.h>
 
 #include "../endian/endian.hpp"
+#include "../memory/pool.hpp"
+
+#include <algorithm>
+#include <array>
 
 void request::send_buffer(socket_t& socket, const void* const buffer, const request_buffer_size_t total_buffer_size, const request_buffer_size_t header_size)
 {
-	socket.write<request_buffer_size_t>(endian::to_little(header_size));
+	const request_buffer_size_t little_endian_header_size = endian::to_little(header_size);
+
+	const std::array<socket_buffer_t, 2> frame = {{
+		{ .data = &little_endian_header_size, .size = sizeof(little_endian_header_size) },
+		{ .data = buffer, .size = total_buffer_size }
+	}};
 
-	socket.write(buffer, total_buffer_size);
+	socket.gather_write(frame);
 }
 
 void request::send_buffer(socket_t& socket, const std::vector<std::uint8_t>& buffer, const request_buffer_size_t header_size)
@@ -18,34 +27,161 @@ void request::send_buffer(socket_t& socket, const std::vector<std::uint8_t>& buf
 	send_buffer(socket, buffer.data(), buffer.size(), header_size);
 }
 
-std::vector<std::uint8_t> request::construct::make_request_header(const request_id_t request_id, const std::uint64_t body_size)
+void request::send_buffer(socket_t& socket, const request_t& request, const compression::options_t& compression_options)
+{
+	request_t compressed_request = { };
+
+	const request_t& sent_request = construct::compress_request(request, compression_options, compressed_request) ? compressed_request : request;
+
+	socket.write(sent_request.frame.data(), sent_request.frame.size());
+}
+
+std::uint8_t request::send_stream(socket_t& socket, const request_id_t request_id, const correlation_id_t correlation_id, const frame::chunk_source_t& source,
+	const compression::options_t& compression_options, const frame::wire_version_t version)
+{
+	static thread_local std::vector<std::uint8_t> chunk_buffer;
+
+	chunk_buffer.resize(frame::default_chunk_size);
+
+	while (true)
+	{
+		const std::uint64_t size = std::min<std::uint64_t>(source(chunk_buffer), chunk_buffer.size());
+
+		// the source only reports that it is exhausted once asked again, so the stream ends with an empty last chunk
+		const frame::chunk_t chunk_type = size == 0 ? frame::chunk_t::last : frame::chunk_t::partial;
+
+		const request_t request = construct::make_request_chunk(request_id, correlation_id, std::span<const std::uint8_t>(chunk_buffer.data(), size), chunk_type, version);
+		request_t compressed_request = { };
+
+		const request_t& sent_request = construct::compress_request(request, compression_options, compressed_request) ? compressed_request : request;
+
+		if (!socket.write(sent_request.frame.data(), sent_request.frame.size()))
+		{
+			return 0;
+		}
+
+		if (chunk_type == frame::chunk_t::last)
+		{
+			return 1;
+		}
+	}
+}
+
+std::vector<std::uint8_t> request::construct::make_request_header(const request_id_t request_id, const correlation_id_t correlation_id, const std::uint64_t body_size)
+{
+	return serialisation::serialise(CREATION_WRAPPER(CreateRequestHeader), request_id, body_size, correlation_id);
+}
+
+// writes the header in front of the body already in the builder, as a size prefixed table for v1 or the fixed layout for v2
+static request::request_t finish_request(flatbuffers::FlatBufferBuilder& builder, const frame::header_t& header, const frame::wire_version_t version)
+{
+	if (version == frame::wire_version_t::v2)
+	{
+		const std::array<std::uint8_t, frame::v2_header_size> encoded_header = frame::encode_v2(header);
+
+		builder.PushBytes(encoded_header.data(), encoded_header.size());
+
+		return { .body_offset = frame::v2_header_size, .frame = builder.Release() };
+	}
+
+	const request::request_buffer_size_t header_size = serialisation::finish(builder, CREATION_WRAPPER(CreateRequestHeader),
+		header.type, header.body_size, header.correlation_id, static_cast<std::uint8_t>(header.compression), header.uncompressed_size, static_cast<std::uint8_t>(header.chunk));
+
+	serialisation::prefix_little_endian(builder, header_size);
+
+	return { .body_offset = sizeof(request::request_buffer_size_t) + header_size, .frame = builder.Release() };
+}
+
+// the body is finished first and the header is built in front of it in the same builder,
+// so the whole frame is one pooled allocation that is handed to the socket without being copied
+template <class creation_function_t, class ...body_arguments_t>
+static request::request_t make_request(const request::request_id_t request_id, const request::correlation_id_t correlation_id, const frame::wire_version_t version,
+	const creation_function_t& creation_function, body_arguments_t&&... body_arguments)
 {
-	return serialisation::serialise(CREATION_WRAPPER(CreateRequestHeader), request_id, body_size);
+	flatbuffers::FlatBufferBuilder builder(serialisation::initial_frame_size, &memory::frame_allocator());
+
+	const std::uint64_t body_size = serialisation::finish(builder, creation_function, std::forward<body_arguments_t>(body_arguments)...);
+
+	return finish_request(builder, { .type = request_id, .chunk = frame::chunk_t::none, .compression = compression::codec_t::none, .correlation_id = correlation_id,
+		.body_size = body_size, .uncompressed_size = 0 }, version);
 }
 
-static void add_header_to_request(const request::request_id_t request_id, request::request_t& request)
+request::request_t request::construct::make_test_request(const correlation_id_t correlation_id, const std::uint64_t key, const std::span<const std::uint8_t> payload,
+	const frame::wire_version_t version)
 {
-	std::vector<std::uint8_t>& request_buffer = request.buffer;
+	return make_request(Client::RequestId_Test, correlation_id, version,
+		[](flatbuffers::FlatBufferBuilder& builder, const std::uint64_t key, const std::span<const std::uint8_t> payload)
+		{
+			// an empty payload is left out of the table entirely
+			const auto payload_offset = payload.empty() ? flatbuffers::Offset<flatbuffers::Vector<std::uint8_t>>() : builder.CreateVector(payload.data(), payload.size());
 
-	const std::vector<std::uint8_t> request_header = request::construct::make_request_header(request_id, request_buffer.size());
+			return Client::CreateTestRequest(builder, key, payload_offset);
+		},
+		key, payload
+	);
+}
+
+request::request_t request::construct::make_stats_request(const correlation_id_t correlation_id, const frame::wire_version_t version)
+{
+	return make_request(Client::RequestId_Stats, correlation_id, version, CREATION_WRAPPER(Client::CreateStatsRequest));
+}
 
-	request_buffer.insert(request_buffer.begin(), request_header.begin(), request_header.end());
+request::request_t request::construct::make_compression_request(const correlation_id_t correlation_id, const std::span<const compression::codec_t> codecs,
+	const frame::wire_version_t version)
+{
+	return make_request(Client::RequestId_Compression, correlation_id, version,
+		[](flatbuffers::FlatBufferBuilder& builder, const std::span<const compression::codec_t> codecs)
+		{
+			const auto codecs_offset = builder.CreateVector(reinterpret_cast<const std::uint8_t*>(codecs.data()), codecs.size());
 
-	request.header_size = request_header.size();
+			return Client::CreateCompressionRequest(builder, codecs_offset, compression::dictionary_id());
+		},
+		codecs
+	);
 }
 
-static request::request_t make_request_from_body(const request::request_id_t request_id, const std::vector<std::uint8_t>& request_body)
+request::request_t request::construct::make_request_chunk(const request_id_t request_id, const correlation_id_t correlation_id, const std::span<const std::uint8_t> chunk,
+	const frame::chunk_t chunk_type, const frame::wire_version_t version)
 {
-	request::request_t request = { .header_size = 0, .buffer = request_body };
+	flatbuffers::FlatBufferBuilder builder(serialisation::initial_frame_size + chunk.size(), &memory::frame_allocator());
 
-	add_header_to_request(request_id, request);
+	builder.PushBytes(chunk.data(), chunk.size());
 
-	return request;
+	return finish_request(builder, { .type = request_id, .chunk = chunk_type, .compression = compression::codec_t::none, .correlation_id = correlation_id,
+		.body_size = chunk.size(), .uncompressed_size = 0 }, version);
 }
 
-request::request_t request::construct::make_test_request(const std::uint64_t key)
+std::uint8_t request::construct::compress_request(const request_t& request, const compression::options_t& compression_options, request_t& compressed_request)
 {
-	const std::vector<std::uint8_t> request_body = serialisation::serialise(CREATION_WRAPPER(Client::CreateTestRequest), key);
+	const std::span<const std::uint8_t> body(request.frame.data() + request.body_offset, request.frame.size() - request.body_offset);
+
+	if (compression_options.codec == compression::codec_t::none || body.size() < compression_options.min_size)
+	{
+		return 0;
+	}
+
+	static thread_local std::vector<std::uint8_t> compressed_body;
+
+	if (!compression::compress(compression_options, body, compressed_body))
+	{
+		return 0;
+	}
+
+	frame::header_t header = { };
+	frame::wire_version_t version = frame::wire_version_t::v1;
+
+	(void)frame::read_header<RequestHeader>(std::span<const std::uint8_t>(request.frame.data(), request.frame.size()), header, version);
+
+	header.compression = compression_options.codec;
+	header.body_size = compressed_body.size();
+	header.uncompressed_size = body.size();
+
+	// the compressed body is pushed first and the header is built in front of it, as make_request does with the body
+	flatbuffers::FlatBufferBuilder builder(serialisation::initial_frame_size + compressed_body.size(), &memory::frame_allocator());
+
+	builder.PushBytes(compressed_body.data(), compressed_body.size());
+
+	compressed_request = finish_request(builder, header, version);
 
-	return make_request_from_body(Client::RequestId_Test, request_body);
+	return 1;
 }
@@ -1,16 +1,43 @@
 #pragma once
 #include "../network/socket.hpp"
 #include "request_def.hpp"
+#include "../compression/compression.hpp"
+#include "../frame/frame.hpp"
 
 namespace request
 {
+	// frames buffer as v1 behind its header_size
 	void send_buffer(socket_t& socket, const void* buffer, request_buffer_size_t total_buffer_size, request_buffer_size_t header_size);
 	void send_buffer(socket_t& socket, const std::vector<std::uint8_t>& buffer, request_buffer_size_t header_size);
 
+	// a body of at least compression_options.min_size is compressed first, if that makes it smaller
+	void send_buffer(socket_t& socket, const request_t& request, const compression::options_t& compression_options = compression::disabled);
+
+	// sends the body pulled from source as a run of chunk frames, holding one chunk of it at a time,
+	// returns 0 if a write failed part way through the stream
+	std::uint8_t send_stream(socket_t& socket, request_id_t request_id, correlation_id_t correlation_id, const frame::chunk_source_t& source,
+		const compression::options_t& compression_options = compression::disabled, frame::wire_version_t version = frame::wire_version_t::v1);
+
+	// every frame is built in the wire format given, which is v1 unless the session or connection speaks v2
 	namespace construct
 	{
-		std::vector<std::uint8_t> make_request_header(request_id_t request_id, std::uint64_t body_size);
+		// a v1 header, without its size prefix
+		std::vector<std::uint8_t> make_request_header(request_id_t request_id, correlation_id_t correlation_id, std::uint64_t body_size);
+
+		// the server echoes the payload back in its test response
+		request_t make_test_request(correlation_id_t correlation_id, std::uint64_t key, std::span<const std::uint8_t> payload = { }, frame::wire_version_t version = frame::wire_version_t::v1);
+
+		request_t make_stats_request(correlation_id_t correlation_id, frame::wire_version_t version = frame::wire_version_t::v1);
+
+		// offers codecs, in the client's order of preference, and the id of any dictionary loaded
+		request_t make_compression_request(correlation_id_t correlation_id, std::span<const compression::codec_t> codecs, frame::wire_version_t version = frame::wire_version_t::v1);
+
+		// one frame of a streamed body, whose chunk is carried as raw bytes rather than a table
+		request_t make_request_chunk(request_id_t request_id, correlation_id_t correlation_id, std::span<const std::uint8_t> chunk, frame::chunk_t chunk_type,
+			frame::wire_version_t version = frame::wire_version_t::v1);
 
-		request_t make_test_request(std::uint64_t key);
+		// rebuilds the frame around its compressed body in the same wire format, returns 0 and leaves compressed_request alone if the body
+		// is too small or does not shrink
+		std::uint8_t compress_request(const request_t& request, const compression::options_t& compression_options, request_t& compressed_request);
 	}
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include "../serialisation/serialisation.hpp"
+
 #include <cstdint>
 
 namespace request
@@ -6,9 +8,13 @@ namespace request
 	typedef std::uint8_t request_id_t;
 	typedef std::uint64_t request_buffer_size_t;
 
+	// chosen by the client and echoed in the response header, so responses may arrive in any order
+	typedef std::uint64_t correlation_id_t;
+
+	// frame layout: little endian header size then header for v1, or the fixed v2 header, then the body from body_offset
 	struct request_t
 	{
-		request_buffer_size_t header_size;
-		std::vector<std::uint8_t> buffer;
+		std::uint64_t body_offset;
+		serialisation::frame_t frame;
 	};
 }
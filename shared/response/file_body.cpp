@@ -0,0 +1,131 @@
+#include "file_body.hpp"
+
+#ifndef _WIN32
+#include "../logging/logging.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+response::file_body_t::~file_body_t()
+{
+	if (mapping_ != nullptr)
+	{
+		munmap(mapping_, mapping_size_);
+	}
+
+	close(file_descriptor_);
+}
+
+std::uint8_t response::file_body_t::map()
+{
+	// an empty range has nothing to map
+	if (mapping_ != nullptr || size_ == 0)
+	{
+		return mapping_ != nullptr;
+	}
+
+	const std::uint64_t page_size = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+	const std::uint64_t mapping_offset = offset_ - offset_ % page_size;
+	const std::uint64_t mapping_size = size_ + (offset_ - mapping_offset);
+
+	void* const mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, file_descriptor_, static_cast<off_t>(mapping_offset));
+
+	if (mapping == MAP_FAILED)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to map file body ({})", std::strerror(errno));
+
+		return 0;
+	}
+
+	// it is written front to back once, so the kernel can read ahead and drop pages behind the write
+	madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+
+	mapping_ = mapping;
+	mapping_size_ = mapping_size;
+
+	return 1;
+}
+
+std::int32_t response::file_body_t::file_descriptor() const
+{
+	return file_descriptor_;
+}
+
+std::uint64_t response::file_body_t::offset() const
+{
+	return offset_;
+}
+
+std::uint64_t response::file_body_t::size() const
+{
+	return size_;
+}
+
+const std::uint8_t* response::file_body_t::mapped_data() const
+{
+	if (mapping_ == nullptr)
+	{
+		return nullptr;
+	}
+
+	return static_cast<const std::uint8_t*>(mapping_) + (mapping_size_ - size_);
+}
+
+std::shared_ptr<response::file_body_t> response::open_file_body(const std::string& path, const std::uint64_t offset, const std::uint64_t size, const std::uint8_t is_mapped)
+{
+	const std::int32_t file_descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (file_descriptor < 0)
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to open file body {} ({})", path, std::strerror(errno));
+
+		return nullptr;
+	}
+
+	struct stat file_status = { };
+
+	if (fstat(file_descriptor, &file_status) != 0)
+	{
+		close(file_descriptor);
+
+		return nullptr;
+	}
+
+	const auto file_size = static_cast<std::uint64_t>(file_status.st_size);
+
+	if (offset > file_size || (size != to_end_of_file && size > file_size - offset))
+	{
+		LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "file body {} is shorter than its range", path);
+
+		close(file_descriptor);
+
+		return nullptr;
+	}
+
+	auto body = std::make_shared<file_body_t>(file_descriptor, offset, size == to_end_of_file ? file_size - offset : size);
+
+	if (is_mapped)
+	{
+		(void)body->map();
+	}
+
+	return body;
+}
+
+awaitable_t<std::uint8_t> response::co_send_file_body(socket_t& socket, const file_body_t& body)
+{
+	if (body.mapped_data() != nullptr && !socket.can_send_file_directly())
+	{
+		co_return co_await socket.co_write(body.mapped_data(), body.size());
+	}
+
+	co_return co_await socket.co_send_file(body.file_descriptor(), body.offset(), body.size());
+}
+#endif
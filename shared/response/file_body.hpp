@@ -0,0 +1,64 @@
+#pragma once
+#include "../network/socket.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace response
+{
+	// declared everywhere so write queues can hold bodies, which can only be opened and sent where the posix file apis exist
+	class file_body_t;
+}
+
+#ifndef _WIN32
+namespace response
+{
+	constexpr std::uint64_t to_end_of_file = std::numeric_limits<std::uint64_t>::max();
+
+	// a response body left where it lies on disk instead of being copied into a frame, the write path holds a reference
+	// until it has been sent, and the file is closed and unmapped once the last one goes
+	class file_body_t
+	{
+	public:
+		// takes ownership of the descriptor
+		explicit file_body_t(std::int32_t file_descriptor, std::uint64_t offset, std::uint64_t size)
+				:	file_descriptor_(file_descriptor),
+					offset_(offset),
+					size_(size) { }
+
+		~file_body_t();
+
+		file_body_t(const file_body_t&) = delete;
+		file_body_t& operator=(const file_body_t&) = delete;
+
+		// lets a socket the kernel cannot send the file through write it from the page cache, rather than reading it
+		// in chunks, returns 0 if the range could not be mapped, in which case the body is still sent in chunks
+		std::uint8_t map();
+
+		[[nodiscard]] std::int32_t file_descriptor() const;
+		[[nodiscard]] std::uint64_t offset() const;
+		[[nodiscard]] std::uint64_t size() const;
+
+		// null until the range has been mapped
+		[[nodiscard]] const std::uint8_t* mapped_data() const;
+
+	protected:
+		std::int32_t file_descriptor_;
+		std::uint64_t offset_;
+		std::uint64_t size_;
+
+		// mappings start on a page boundary, so the range may begin part way into this one
+		void* mapping_ = nullptr;
+		std::uint64_t mapping_size_ = 0;
+	};
+
+	// size bytes of the file from offset, or the rest of it, null if the file cannot be opened or is shorter than the range
+	std::shared_ptr<file_body_t> open_file_body(const std::string& path, std::uint64_t offset = 0, std::uint64_t size = to_end_of_file, std::uint8_t is_mapped = 0);
+
+	// with sendfile where the socket's kernel can send the file itself, otherwise written from the mapping,
+	// or read and written in chunks if the body is not mapped
+	awaitable_t<std::uint8_t> co_send_file_body(socket_t& socket, const file_body_t& body);
+}
+#endif
@@ -4,39 +4,323 @@
 #include <schema/schema.hpp>
 
 #include "../endian/endian.hpp"
+#include "../memory/pool.hpp"
 
-void response::async_send_buffer(socket_t& socket, const std::shared_ptr<std::vector<std::uint8_t>>& buffer, const async_callback_t& handler)
+#include <array>
+#include <cstring>
+
+void response::async_send_buffer(socket_t& socket, const request::correlation_id_t correlation_id, const std::shared_ptr<std::vector<std::uint8_t>>& body_buffer, const async_callback_t& handler,
+	const compression::options_t& compression_options)
 {
-	const request::request_buffer_size_t buffer_size = buffer->size();
+	// the gather write copies the buffers before it returns, so the compressed body need not outlive this call
+	std::vector<std::uint8_t> compressed_body;
+
+	const std::uint8_t is_compressed = compression_options.codec != compression::codec_t::none && body_buffer->size() >= compression_options.min_size
+		&& compression::compress(compression_options, *body_buffer, compressed_body);
+
+	const std::span<const std::uint8_t> body = is_compressed ? std::span<const std::uint8_t>(compressed_body) : std::span<const std::uint8_t>(*body_buffer);
+
+	const std::vector<std::uint8_t> header_buffer = is_compressed
+		? construct::make_response_header(correlation_id, body.size(), compression_options.codec, body_buffer->size())
+		: construct::make_response_header(correlation_id, body.size());
+
+	const request::request_buffer_size_t little_endian_header_size = endian::to_little<request::request_buffer_size_t>(header_buffer.size());
+
+	const std::array<socket_buffer_t, 3> frame = {{
+		{ .data = &little_endian_header_size, .size = sizeof(little_endian_header_size) },
+		{ .data = header_buffer.data(), .size = header_buffer.size() },
+		{ .data = body.data(), .size = body.size() }
+	}};
+
+	socket.async_gather_write(frame, handler);
+}
 
-	const auto buffer_size_begin = reinterpret_cast<const std::uint8_t*>(&buffer_size);
+void response::async_send_buffer(socket_t& socket, const std::shared_ptr<serialisation::frame_t>& frame, const async_callback_t& handler, const compression::options_t& compression_options)
+{
+	serialisation::frame_t compressed_frame;
 
-	buffer->insert(buffer->begin(), buffer_size_begin, buffer_size_begin + sizeof(buffer_size));
+	const std::shared_ptr<serialisation::frame_t> sent_frame = construct::compress_response(*frame, compression_options, compressed_frame)
+		? std::make_shared<serialisation::frame_t>(std::move(compressed_frame))
+		: frame;
 
-	socket.async_write(buffer->data(), buffer->size(),
-		[handler, buffer](const std::uint8_t is_valid)
+	socket.async_write(sent_frame->data(), sent_frame->size(),
+		[handler, sent_frame](const std::uint8_t is_valid)
 		{
-			(void)buffer;
+			(void)sent_frame;
 
 			handler(is_valid);
 		}
 	);
 }
 
-void response::read_buffer(socket_t& socket, std::vector<std::uint8_t>& buffer)
+// the first 8 bytes of a frame are either a v1 header size or the start of a v2 header
+static std::uint8_t read_header(socket_t& socket, std::vector<std::uint8_t>& buffer, frame::header_t& header)
+{
+	std::array<std::uint8_t, frame::v2_header_size> header_buffer = { };
+
+	constexpr std::uint64_t prefix_size = sizeof(request::request_buffer_size_t);
+
+	if (!socket.read(header_buffer.data(), prefix_size))
+	{
+		return 0;
+	}
+
+	if (frame::is_v2(std::span<const std::uint8_t>(header_buffer.data(), prefix_size)))
+	{
+		return socket.read(header_buffer.data() + prefix_size, frame::v2_header_size - prefix_size) && frame::decode_v2(header_buffer.data(), header);
+	}
+
+	request::request_buffer_size_t little_endian_header_size = 0;
+
+	std::memcpy(&little_endian_header_size, header_buffer.data(), prefix_size);
+
+	const request::request_buffer_size_t header_size = endian::from_little(little_endian_header_size);
+
+	if (header_size > frame::default_response_limits.max_header_size)
+	{
+		return 0;
+	}
+
+	buffer.resize(header_size);
+
+	if (!socket.read(buffer.data(), header_size) || !serialisation::is_valid<ResponseHeader>(buffer))
+	{
+		return 0;
+	}
+
+	header = frame::decode_v1(serialisation::deserialise<ResponseHeader>(buffer));
+
+	return 1;
+}
+
+// reads one frame, leaving its body in buffer
+static std::uint8_t read_frame(socket_t& socket, std::vector<std::uint8_t>& buffer, request::correlation_id_t& correlation_id, frame::chunk_t& chunk_type)
+{
+	frame::header_t header = { };
+
+	if (!read_header(socket, buffer, header))
+	{
+		return 0;
+	}
+
+	correlation_id = header.correlation_id;
+	chunk_type = header.chunk;
+
+	const std::uint64_t body_size = header.body_size;
+
+	if (body_size > frame::default_response_limits.max_body_size)
+	{
+		return 0;
+	}
+
+	if (header.compression == compression::codec_t::none)
+	{
+		buffer.resize(body_size);
+
+		return socket.read(buffer.data(), body_size);
+	}
+
+	static thread_local std::vector<std::uint8_t> compressed_body;
+
+	compressed_body.resize(body_size);
+
+	return socket.read(compressed_body.data(), body_size) && compression::decompress(header.compression, compressed_body, header.uncompressed_size, buffer);
+}
+
+std::uint8_t response::read_buffer(socket_t& socket, std::vector<std::uint8_t>& buffer, request::correlation_id_t& correlation_id)
+{
+	frame::chunk_t chunk_type = frame::chunk_t::none;
+
+	return read_frame(socket, buffer, correlation_id, chunk_type);
+}
+
+std::uint8_t response::read_stream(socket_t& socket, const frame::chunk_sink_t& sink, request::correlation_id_t& correlation_id)
+{
+	std::vector<std::uint8_t> chunk_buffer;
+
+	while (true)
+	{
+		frame::chunk_t chunk_type = frame::chunk_t::none;
+
+		if (!read_frame(socket, chunk_buffer, correlation_id, chunk_type) || !sink(chunk_buffer))
+		{
+			return 0;
+		}
+
+		if (chunk_type != frame::chunk_t::partial)
+		{
+			return 1;
+		}
+	}
+}
+
+std::vector<std::uint8_t> response::construct::make_response_header(const request::correlation_id_t correlation_id, const std::uint64_t body_size,
+	const compression::codec_t codec, const std::uint64_t uncompressed_size, const frame::chunk_t chunk_type)
 {
-	request::request_buffer_size_t little_endian_buffer_size = 0;
+	return serialisation::serialise(CREATION_WRAPPER(CreateResponseHeader), correlation_id, body_size, static_cast<std::uint8_t>(codec), uncompressed_size,
+		static_cast<std::uint8_t>(chunk_type));
+}
+
+// writes the header in front of the body already in the builder, as a size prefixed table for v1 or the fixed layout for v2
+static serialisation::frame_t finish_response(flatbuffers::FlatBufferBuilder& builder, const frame::header_t& header, const frame::wire_version_t version)
+{
+	if (version == frame::wire_version_t::v2)
+	{
+		const std::array<std::uint8_t, frame::v2_header_size> encoded_header = frame::encode_v2(header);
+
+		builder.PushBytes(encoded_header.data(), encoded_header.size());
 
-	socket.read(little_endian_buffer_size);
+		return builder.Release();
+	}
 
-	const request::request_buffer_size_t buffer_size = endian::from_little(little_endian_buffer_size);
+	const request::request_buffer_size_t header_size = serialisation::finish(builder, CREATION_WRAPPER(CreateResponseHeader),
+		header.correlation_id, header.body_size, static_cast<std::uint8_t>(header.compression), header.uncompressed_size, static_cast<std::uint8_t>(header.chunk));
 
-	buffer.resize(buffer_size);
+	serialisation::prefix_little_endian(builder, header_size);
 
-	socket.read(buffer.data(), buffer_size);
+	return builder.Release();
+}
+
+static frame::header_t make_header(const request::correlation_id_t correlation_id, const std::uint64_t body_size, const frame::chunk_t chunk_type)
+{
+	return { .type = 0, .chunk = chunk_type, .compression = compression::codec_t::none, .correlation_id = correlation_id, .body_size = body_size, .uncompressed_size = 0 };
 }
 
-std::vector<std::uint8_t> response::construct::make_test_response(std::uint64_t key)
+// the header is written into the builder's headroom, so the frame is one pooled allocation
+template <class creation_function_t, class ...body_arguments_t>
+static serialisation::frame_t make_response(const request::correlation_id_t correlation_id, const frame::wire_version_t version, const creation_function_t& creation_function,
+	body_arguments_t&&... body_arguments)
 {
-	return serialisation::serialise(CREATION_WRAPPER(Client::CreateTestResponse), key);
+	flatbuffers::FlatBufferBuilder builder(serialisation::initial_frame_size, &memory::frame_allocator());
+
+	const std::uint64_t body_size = serialisation::finish(builder, creation_function, std::forward<body_arguments_t>(body_arguments)...);
+
+	return finish_response(builder, make_header(correlation_id, body_size, frame::chunk_t::none), version);
+}
+
+serialisation::frame_t response::construct::make_test_response(const request::correlation_id_t correlation_id, const std::uint64_t key, const std::span<const std::uint8_t> payload,
+	const frame::wire_version_t version)
+{
+	return make_response(correlation_id, version,
+		[](flatbuffers::FlatBufferBuilder& builder, const std::uint64_t key, const std::span<const std::uint8_t> payload)
+		{
+			const auto payload_offset = payload.empty() ? flatbuffers::Offset<flatbuffers::Vector<std::uint8_t>>() : builder.CreateVector(payload.data(), payload.size());
+
+			return Client::CreateTestResponse(builder, key, payload_offset);
+		},
+		key, payload
+	);
+}
+
+static flatbuffers::Offset<Client::Histogram> create_histogram(flatbuffers::FlatBufferBuilder& builder, const metrics::histogram_snapshot_t& histogram)
+{
+	std::vector<std::uint64_t> upper_bounds;
+	std::vector<std::uint64_t> counts;
+
+	for (std::uint64_t i = 0; i < metrics::histogram_bucket_count; i++)
+	{
+		if (histogram.counts[i] != 0)
+		{
+			upper_bounds.push_back(metrics::bucket_upper_bound(i));
+			counts.push_back(histogram.counts[i]);
+		}
+	}
+
+	const auto upper_bounds_offset = builder.CreateVector(upper_bounds.data(), upper_bounds.size());
+	const auto counts_offset = builder.CreateVector(counts.data(), counts.size());
+
+	return Client::CreateHistogram(builder, upper_bounds_offset, counts_offset, histogram.total_count, histogram.sum, histogram.max);
+}
+
+static flatbuffers::Offset<Client::StatsResponse> create_stats_response(flatbuffers::FlatBufferBuilder& builder, const metrics::snapshot_t& snapshot)
+{
+	std::vector<flatbuffers::Offset<Client::RequestTypeStats>> request_types;
+
+	for (std::uint64_t i = 0; i < metrics::request_type_count; i++)
+	{
+		const metrics::request_type_snapshot_t& request_type = snapshot.request_types[i];
+
+		if (request_type.count == 0)
+		{
+			continue;
+		}
+
+		const auto handler_latency = create_histogram(builder, request_type.handler_latency_ns);
+		const auto end_to_end_latency = create_histogram(builder, request_type.end_to_end_latency_ns);
+
+		request_types.push_back(Client::CreateRequestTypeStats(builder, static_cast<std::uint8_t>(i), request_type.count, handler_latency, end_to_end_latency));
+	}
+
+	const auto request_types_offset = builder.CreateVector(request_types.data(), request_types.size());
+	const auto handshake_latency = create_histogram(builder, snapshot.handshake_latency_ns);
+	const auto write_queue_depth = create_histogram(builder, snapshot.write_queue_depth);
+
+	return Client::CreateStatsResponse(builder, snapshot.accepted_connections, snapshot.handshake_successes, snapshot.handshake_failures, handshake_latency,
+		snapshot.bytes_in, snapshot.bytes_out, request_types_offset, write_queue_depth, snapshot.oversized_frames, snapshot.connection_budget_pauses, snapshot.global_budget_pauses);
+}
+
+serialisation::frame_t response::construct::make_stats_response(const request::correlation_id_t correlation_id, const metrics::snapshot_t& snapshot, const frame::wire_version_t version)
+{
+	return make_response(correlation_id, version, create_stats_response, snapshot);
+}
+
+serialisation::frame_t response::construct::make_compression_response(const request::correlation_id_t correlation_id, const compression::codec_t codec, const frame::wire_version_t version)
+{
+	return make_response(correlation_id, version, CREATION_WRAPPER(Client::CreateCompressionResponse), static_cast<std::uint8_t>(codec));
+}
+
+serialisation::frame_t response::construct::make_response_chunk(const request::correlation_id_t correlation_id, const std::span<const std::uint8_t> chunk, const frame::chunk_t chunk_type,
+	const frame::wire_version_t version)
+{
+	flatbuffers::FlatBufferBuilder builder(serialisation::initial_frame_size + chunk.size(), &memory::frame_allocator());
+
+	builder.PushBytes(chunk.data(), chunk.size());
+
+	return finish_response(builder, make_header(correlation_id, chunk.size(), chunk_type), version);
+}
+
+serialisation::frame_t response::construct::make_response_header_frame(const request::correlation_id_t correlation_id, const std::uint64_t body_size, const frame::wire_version_t version)
+{
+	flatbuffers::FlatBufferBuilder builder(serialisation::initial_frame_size, &memory::frame_allocator());
+
+	return finish_response(builder, make_header(correlation_id, body_size, frame::chunk_t::none), version);
+}
+
+std::uint8_t response::construct::compress_response(const serialisation::frame_t& frame, const compression::options_t& compression_options, serialisation::frame_t& compressed_frame)
+{
+	if (compression_options.codec == compression::codec_t::none)
+	{
+		return 0;
+	}
+
+	frame::header_t header = { };
+	frame::wire_version_t version = frame::wire_version_t::v1;
+
+	const std::uint64_t body_offset = frame::read_header<ResponseHeader>(std::span<const std::uint8_t>(frame.data(), frame.size()), header, version);
+	const std::span<const std::uint8_t> body(frame.data() + body_offset, frame.size() - body_offset);
+
+	if (body.size() < compression_options.min_size)
+	{
+		return 0;
+	}
+
+	static thread_local std::vector<std::uint8_t> compressed_body;
+
+	if (!compression::compress(compression_options, body, compressed_body))
+	{
+		return 0;
+	}
+
+	header.compression = compression_options.codec;
+	header.body_size = compressed_body.size();
+	header.uncompressed_size = body.size();
+
+	// the compressed body is pushed first and the header is built in front of it, as make_response does with the body
+	flatbuffers::FlatBufferBuilder builder(serialisation::initial_frame_size + compressed_body.size(), &memory::frame_allocator());
+
+	builder.PushBytes(compressed_body.data(), compressed_body.size());
+
+	compressed_frame = finish_response(builder, header, version);
+
+	return 1;
 }
@@ -1,23 +1,65 @@
 #pragma once
 #include "../network/socket.hpp"
+#include "../request/request_def.hpp"
 #include "../serialisation/serialisation.hpp"
+#include "../metrics/metrics.hpp"
+#include "../compression/compression.hpp"
+#include "../frame/frame.hpp"
 #include <vector>
 
 namespace response
 {
-	void async_send_buffer(socket_t& socket, const std::shared_ptr<std::vector<std::uint8_t>>& buffer, const async_callback_t& handler);
-	void read_buffer(socket_t& socket, std::vector<std::uint8_t>& buffer);
+	// asio does not allow writes to overlap on one stream, so each must complete before the next is started,
+	// the server's connections queue their responses through connection_t::queue_response for this
+	// a body of at least compression_options.min_size is compressed first, if that makes it smaller
+	void async_send_buffer(socket_t& socket, request::correlation_id_t correlation_id, const std::shared_ptr<std::vector<std::uint8_t>>& body_buffer, const async_callback_t& handler,
+		const compression::options_t& compression_options = compression::disabled);
+	void async_send_buffer(socket_t& socket, const std::shared_ptr<serialisation::frame_t>& frame, const async_callback_t& handler, const compression::options_t& compression_options = compression::disabled);
+
+	// buffer receives the response body, decompressed if it was sent compressed, a streamed response is read with read_stream,
+	// frames of either wire format are read
+	std::uint8_t read_buffer(socket_t& socket, std::vector<std::uint8_t>& buffer, request::correlation_id_t& correlation_id);
+
+	// passes a response to sink one frame at a time, so a streamed body is never held whole, a response which was not
+	// streamed reaches sink as a single chunk, returns 0 if a read failed or sink abandoned the transfer
+	std::uint8_t read_stream(socket_t& socket, const frame::chunk_sink_t& sink, request::correlation_id_t& correlation_id);
 
 	template <class t>
-	const t* read_response(socket_t& socket, std::vector<std::uint8_t>& buffer)
+	const t* read_response(socket_t& socket, std::vector<std::uint8_t>& buffer, request::correlation_id_t& correlation_id)
 	{
-		response::read_buffer(socket, buffer);
+		if (!response::read_buffer(socket, buffer, correlation_id) || !serialisation::is_valid<t>(buffer))
+		{
+			return nullptr;
+		}
 
 		return serialisation::deserialise<t>(buffer);
 	}
 
+	// every frame is built in the wire format given, which is the one the connection's client opened it with
 	namespace construct
 	{
-		std::vector<std::uint8_t> make_test_response(std::uint64_t key);
+		// a v1 header, without its size prefix
+		std::vector<std::uint8_t> make_response_header(request::correlation_id_t correlation_id, std::uint64_t body_size,
+			compression::codec_t codec = compression::codec_t::none, std::uint64_t uncompressed_size = 0, frame::chunk_t chunk_type = frame::chunk_t::none);
+
+		// frame layout: little endian header size then header for v1, or the fixed v2 header, then the body
+		serialisation::frame_t make_test_response(request::correlation_id_t correlation_id, std::uint64_t key, std::span<const std::uint8_t> payload = { },
+			frame::wire_version_t version = frame::wire_version_t::v1);
+
+		// request types which have not been seen are left out
+		serialisation::frame_t make_stats_response(request::correlation_id_t correlation_id, const metrics::snapshot_t& snapshot, frame::wire_version_t version = frame::wire_version_t::v1);
+
+		serialisation::frame_t make_compression_response(request::correlation_id_t correlation_id, compression::codec_t codec, frame::wire_version_t version = frame::wire_version_t::v1);
+
+		// one frame of a streamed body, whose chunk is carried as raw bytes rather than a table
+		serialisation::frame_t make_response_chunk(request::correlation_id_t correlation_id, std::span<const std::uint8_t> chunk, frame::chunk_t chunk_type,
+			frame::wire_version_t version = frame::wire_version_t::v1);
+
+		// the header of a response whose body is sent straight after it from elsewhere, such as a file body
+		serialisation::frame_t make_response_header_frame(request::correlation_id_t correlation_id, std::uint64_t body_size, frame::wire_version_t version = frame::wire_version_t::v1);
+
+		// rebuilds the frame around its compressed body in the same wire format, returns 0 and leaves compressed_frame alone if the body
+		// is too small or does not shrink
+		std::uint8_t compress_response(const serialisation::frame_t& frame, const compression::options_t& compression_options, serialisation::frame_t& compressed_frame);
 	}
 }
@@ -1,11 +1,19 @@
 #pragma once
 #include <flatbuffers/flatbuffers.h>
 
+#include "../endian/endian.hpp"
+
 #include <vector>
 #include <span>
 
 namespace serialisation
 {
+	// a complete frame which owns the builder's allocation, so it can be sent without being copied
+	typedef flatbuffers::DetachedBuffer frame_t;
+
+	// frames are built with this much room up front, which keeps the common frame in one of the pool's small size classes
+	constexpr std::uint64_t initial_frame_size = 256;
+
 	static std::vector<std::uint8_t> builder_to_vector(const flatbuffers::FlatBufferBuilder& builder)
 	{
 		const std::uint8_t* const buffer = builder.GetBufferPointer();
@@ -32,6 +40,27 @@ namespace serialisation
 		return serialise(builder, creation_function, std::forward<arguments_t>(arguments)...);
 	}
 
+	template <class creation_function_t, class ...arguments_t>
+	static std::uint64_t finish(flatbuffers::FlatBufferBuilder& builder, const creation_function_t& creation_function, arguments_t&&... arguments)
+	{
+		const std::uint64_t previous_size = builder.GetSize();
+
+		const auto root = creation_function(builder, std::forward<arguments_t>(arguments)...);
+
+		builder.Finish(root);
+
+		return builder.GetSize() - previous_size;
+	}
+
+	// flatbuffers builds back to front, so prefixing a finished buffer writes into its headroom instead of moving it
+	template <class t>
+	static void prefix_little_endian(flatbuffers::FlatBufferBuilder& builder, const t value)
+	{
+		const t little_endian_value = endian::to_little(value);
+
+		builder.PushBytes(reinterpret_cast<const std::uint8_t*>(&little_endian_value), sizeof(little_endian_value));
+	}
+
 	template <class t>
 	static const t* deserialise(const void* const buffer)
 	{
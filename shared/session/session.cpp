@@ -0,0 +1,529 @@
+#include "session.hpp"
+#include "../frame/frame.hpp"
+#include "../request/request.hpp"
+#include "../logging/logging.hpp"
+#include <schema/response_generated.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+client_session_t::~client_session_t()
+{
+	socket_->close();
+}
+
+void client_session_t::start()
+{
+	read_responses();
+}
+
+void client_session_t::set_wire_version(const frame::wire_version_t version)
+{
+	wire_version_ = version;
+}
+
+void client_session_t::close()
+{
+	boost::asio::post(*io_context_,
+		[self = shared_from_this()]()
+		{
+			self->shut_down();
+		}
+	);
+}
+
+void client_session_t::async_request(const request_factory_t& request_factory, const response_callback_t& handler)
+{
+	queue_request(request_factory, { .handler = handler, .sink = { } });
+}
+
+void client_session_t::async_request(const request_factory_t& request_factory, const frame::chunk_sink_t& sink, const async_callback_t& handler)
+{
+	queue_request(request_factory, make_streamed_request(sink, handler));
+}
+
+void client_session_t::async_stream_request(const request::request_id_t request_id, frame::chunk_source_t source, const frame::chunk_sink_t& sink, const async_callback_t& handler)
+{
+	request::correlation_id_t correlation_id = 0;
+	std::uint8_t should_write = 0;
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		if (is_open_)
+		{
+			correlation_id = pending_requests_.add(make_streamed_request(sink, handler));
+
+			queued_uploads_.push_back({ .request_id = request_id, .correlation_id = correlation_id, .source = std::move(source) });
+
+			request_count_++;
+
+			// otherwise the write in flight pulls the first chunk when it completes
+			should_write = !is_writing_;
+
+			is_writing_ = 1;
+		}
+	}
+
+	if (correlation_id == 0)
+	{
+		handler(0);
+
+		return;
+	}
+
+	if (should_write)
+	{
+		boost::asio::post(*io_context_,
+			[self = shared_from_this()]()
+			{
+				self->write_queued_frames();
+			}
+		);
+	}
+}
+
+// the last chunk goes through the sink like the others before handler hears that the response is complete
+client_session_t::pending_request_t client_session_t::make_streamed_request(const frame::chunk_sink_t& sink, const async_callback_t& handler)
+{
+	return {
+		.handler = [sink, handler](const std::uint8_t is_valid, const std::span<std::uint8_t> body_buffer)
+		{
+			handler(is_valid && (body_buffer.empty() || sink(body_buffer)));
+		},
+		.sink = sink
+	};
+}
+
+void client_session_t::queue_request(const request_factory_t& request_factory, pending_request_t pending)
+{
+	request::correlation_id_t correlation_id = 0;
+	compression::options_t compression_options = compression::disabled;
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		// the pending request is only moved from once the session is known to be open
+		if (is_open_)
+		{
+			correlation_id = pending_requests_.add(std::move(pending));
+			compression_options = compression_options_;
+
+			request_count_++;
+		}
+	}
+
+	if (correlation_id == 0)
+	{
+		pending.handler(0, { });
+
+		return;
+	}
+
+	request::request_t request = request_factory(correlation_id, wire_version_);
+	request::request_t compressed_request = { };
+
+	if (request::construct::compress_request(request, compression_options, compressed_request))
+	{
+		request = std::move(compressed_request);
+	}
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		queued_frames_.push_back(std::move(request.frame));
+
+		// the write in flight picks this frame up when it completes
+		if (is_writing_ || !is_open_)
+		{
+			return;
+		}
+
+		is_writing_ = 1;
+	}
+
+	boost::asio::post(*io_context_,
+		[self = shared_from_this()]()
+		{
+			self->write_queued_frames();
+		}
+	);
+}
+
+std::future<std::optional<std::vector<std::uint8_t>>> client_session_t::request(const request_factory_t& request_factory)
+{
+	const auto promise = std::make_shared<std::promise<std::optional<std::vector<std::uint8_t>>>>();
+
+	async_request(request_factory,
+		[promise](const std::uint8_t is_valid, const std::span<std::uint8_t> body_buffer)
+		{
+			if (is_valid)
+			{
+				promise->set_value(std::vector<std::uint8_t>(body_buffer.begin(), body_buffer.end()));
+			}
+			else
+			{
+				promise->set_value(std::nullopt);
+			}
+		}
+	);
+
+	return promise->get_future();
+}
+
+void client_session_t::negotiate_compression(const std::vector<compression::options_t>& offered, const negotiation_callback_t& handler)
+{
+	std::vector<compression::codec_t> codecs;
+
+	for (const compression::options_t& options : offered)
+	{
+		if (options.codec != compression::codec_t::none && compression::is_available(options.codec))
+		{
+			codecs.push_back(options.codec);
+		}
+	}
+
+	async_request(
+		[codecs](const request::correlation_id_t correlation_id, const frame::wire_version_t version)
+		{
+			return request::construct::make_compression_request(correlation_id, codecs, version);
+		},
+		[self = shared_from_this(), offered, handler](const std::uint8_t is_valid, const std::span<std::uint8_t> body_buffer)
+		{
+			compression::codec_t codec = compression::codec_t::none;
+
+			if (is_valid && serialisation::is_valid<Client::CompressionResponse>(body_buffer))
+			{
+				codec = static_cast<compression::codec_t>(serialisation::deserialise<Client::CompressionResponse>(body_buffer)->codec());
+			}
+
+			const auto agreed = std::ranges::find(offered, codec, &compression::options_t::codec);
+
+			if (codec == compression::codec_t::none || agreed == offered.end())
+			{
+				handler(compression::codec_t::none);
+
+				return;
+			}
+
+			{
+				const std::lock_guard lock(self->mutex_);
+
+				self->compression_options_ = *agreed;
+			}
+
+			handler(codec);
+		}
+	);
+}
+
+std::uint64_t client_session_t::pending_count() const
+{
+	const std::lock_guard lock(mutex_);
+
+	return pending_requests_.size();
+}
+
+std::uint64_t client_session_t::request_count() const
+{
+	const std::lock_guard lock(mutex_);
+
+	return request_count_;
+}
+
+std::uint8_t client_session_t::is_open() const
+{
+	const std::lock_guard lock(mutex_);
+
+	return is_open_;
+}
+
+void client_session_t::read_responses()
+{
+	receive_buffer_.reserve();
+
+	const std::span<std::uint8_t> writable = receive_buffer_.writable();
+
+	socket_->async_read_some(writable.data(), writable.size(),
+		[self = shared_from_this()](const std::uint8_t is_valid, const std::uint64_t size)
+		{
+			if (is_valid)
+			{
+				self->receive_buffer_.commit(size);
+
+				if (self->handle_received_responses())
+				{
+					self->read_responses();
+
+					return;
+				}
+			}
+			else
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to read responses from socket");
+			}
+
+			self->shut_down();
+		}
+	);
+}
+
+// routes every complete response in the receive buffer to the request waiting on it
+std::uint8_t client_session_t::handle_received_responses()
+{
+	while (true)
+	{
+		frame::parsed_frame_t response_frame = { };
+		std::uint64_t required_size = 0;
+
+		const frame::parse_status_t status = frame::parse<ResponseHeader>(receive_buffer_.readable(), response_frame, required_size, frame::default_response_limits);
+
+		if (status == frame::parse_status_t::incomplete)
+		{
+			receive_buffer_.require(required_size);
+
+			return 1;
+		}
+
+		if (status == frame::parse_status_t::invalid)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "response header is invalid");
+
+			return 0;
+		}
+
+		if (status == frame::parse_status_t::too_large)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "response frame is larger than the frame limits");
+
+			return 0;
+		}
+
+		std::span<std::uint8_t> body_buffer;
+
+		if (!frame::decompress_body(response_frame, decompressed_body_, body_buffer))
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to decompress response body");
+
+			return 0;
+		}
+
+		receive_buffer_.consume(response_frame.size);
+
+		const request::correlation_id_t correlation_id = response_frame.header.correlation_id;
+		const frame::chunk_t chunk_type = response_frame.header.chunk;
+
+		if (chunk_type == frame::chunk_t::partial)
+		{
+			pass_response_chunk(correlation_id, body_buffer);
+
+			frame::release_scratch(decompressed_body_);
+
+			continue;
+		}
+
+		std::optional<pending_request_t> pending;
+
+		{
+			const std::lock_guard lock(mutex_);
+
+			pending = pending_requests_.take(correlation_id);
+		}
+
+		if (pending.has_value())
+		{
+			pending->handler(1, body_buffer);
+		}
+		// the rest of a streamed response whose request was abandoned part way through is expected
+		else if (chunk_type == frame::chunk_t::none)
+		{
+			LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "received a response for an unknown request ({})", correlation_id);
+		}
+
+		frame::release_scratch(decompressed_body_);
+	}
+}
+
+// a request without a sink cannot take a streamed response, so it fails on the first chunk as one whose sink gave up does
+void client_session_t::pass_response_chunk(const request::correlation_id_t correlation_id, const std::span<std::uint8_t> chunk)
+{
+	frame::chunk_sink_t sink;
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		const pending_request_t* const pending = pending_requests_.find(correlation_id);
+
+		if (pending == nullptr)
+		{
+			return;
+		}
+
+		sink = pending->sink;
+	}
+
+	if (sink && sink(chunk))
+	{
+		return;
+	}
+
+	std::optional<pending_request_t> abandoned;
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		abandoned = pending_requests_.take(correlation_id);
+	}
+
+	if (abandoned.has_value())
+	{
+		abandoned->handler(0, { });
+	}
+}
+
+// every frame queued since the last write goes out in a single gather write
+void client_session_t::write_queued_frames()
+{
+	writing_frames_.clear();
+
+	pull_upload_chunks();
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		if (!is_open_ || (queued_frames_.empty() && queued_uploads_.empty()))
+		{
+			is_writing_ = 0;
+
+			return;
+		}
+
+		writing_frames_.swap(queued_frames_);
+	}
+
+	// only an upload queued since the chunks were pulled is waiting, so it is pulled on another pass
+	if (writing_frames_.empty())
+	{
+		boost::asio::post(*io_context_,
+			[self = shared_from_this()]()
+			{
+				self->write_queued_frames();
+			}
+		);
+
+		return;
+	}
+
+	write_buffers_.clear();
+
+	for (const serialisation::frame_t& frame : writing_frames_)
+	{
+		write_buffers_.push_back({ .data = frame.data(), .size = frame.size() });
+	}
+
+	socket_->async_gather_write(write_buffers_,
+		[self = shared_from_this()](const std::uint8_t is_valid)
+		{
+			if (is_valid)
+			{
+				self->write_queued_frames();
+			}
+			else
+			{
+				LOG_RATE_LIMITED(SPDLOG_LEVEL_ERROR, 10, "failed to write requests to socket");
+
+				self->shut_down();
+			}
+		}
+	);
+}
+
+// queues the next chunk of every body being streamed, so each holds a single chunk while the write carrying it is in flight
+void client_session_t::pull_upload_chunks()
+{
+	compression::options_t compression_options = compression::disabled;
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		// the sources of a closed session are dropped here, on the write chain which owns them
+		if (!is_open_)
+		{
+			uploads_.clear();
+
+			return;
+		}
+
+		uploads_.splice(uploads_.end(), queued_uploads_);
+
+		compression_options = compression_options_;
+	}
+
+	if (uploads_.empty())
+	{
+		return;
+	}
+
+	upload_buffer_.resize(frame::default_chunk_size);
+
+	for (auto upload = uploads_.begin(); upload != uploads_.end();)
+	{
+		std::uint8_t is_abandoned = 0;
+
+		{
+			const std::lock_guard lock(mutex_);
+
+			is_abandoned = pending_requests_.find(upload->correlation_id) == nullptr;
+		}
+
+		// once the response has failed or completed the rest of the body is cut short, with the last chunk still sent
+		// so the server can close its stream
+		const std::uint64_t size = is_abandoned ? 0 : std::min<std::uint64_t>(upload->source(upload_buffer_), upload_buffer_.size());
+		const frame::chunk_t chunk_type = size == 0 ? frame::chunk_t::last : frame::chunk_t::partial;
+
+		request::request_t request = request::construct::make_request_chunk(upload->request_id, upload->correlation_id,
+			std::span<const std::uint8_t>(upload_buffer_.data(), size), chunk_type, wire_version_);
+		request::request_t compressed_request = { };
+
+		if (request::construct::compress_request(request, compression_options, compressed_request))
+		{
+			request = std::move(compressed_request);
+		}
+
+		{
+			const std::lock_guard lock(mutex_);
+
+			queued_frames_.push_back(std::move(request.frame));
+		}
+
+		upload = chunk_type == frame::chunk_t::last ? uploads_.erase(upload) : std::next(upload);
+	}
+}
+
+void client_session_t::shut_down()
+{
+	std::vector<pending_request_t> pending_requests;
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		if (!is_open_)
+		{
+			return;
+		}
+
+		is_open_ = 0;
+
+		pending_requests = pending_requests_.take_all();
+		queued_frames_.clear();
+		queued_uploads_.clear();
+	}
+
+	socket_->close();
+
+	for (const pending_request_t& pending : pending_requests)
+	{
+		pending.handler(0, { });
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "../network/socket.hpp"
+#include "../request/request_def.hpp"
+#include "../request/correlation.hpp"
+#include "../frame/receive_buffer.hpp"
+#include "../frame/frame.hpp"
+#include "../compression/compression.hpp"
+
+#include <future>
+#include <list>
+#include <mutex>
+#include <optional>
+
+// multiplexes many in flight requests over one connected and handshaken socket,
+// must be created as a shared ptr and its io_context must be run by at least one thread
+class client_session_t final : public std::enable_shared_from_this<client_session_t>
+{
+public:
+	typedef boost::asio::io_context asio_context_t;
+
+	// body_buffer is only valid for the duration of the call
+	typedef std::function<void(std::uint8_t is_valid, std::span<std::uint8_t> body_buffer)> response_callback_t;
+
+	// builds the request frame for the correlation id the session assigns to it, in the session's wire format
+	typedef std::function<request::request_t(request::correlation_id_t correlation_id, frame::wire_version_t version)> request_factory_t;
+
+	// receives the codec the server agreed on, none if it had none in common with the offer or the request failed
+	typedef std::function<void(compression::codec_t codec)> negotiation_callback_t;
+
+	explicit client_session_t(std::shared_ptr<asio_context_t> io_context, std::unique_ptr<socket_t> socket)
+			:	io_context_(std::move(io_context)),
+				socket_(std::move(socket)) { }
+
+	~client_session_t();
+
+	void start();
+	void close();
+
+	// set before start, every request is built in this format and the server answers in the one the session opened with,
+	// a server which only speaks v1 refuses a v2 frame and closes the session
+	void set_wire_version(frame::wire_version_t version);
+
+	// both may be called from any thread, handlers run on the io_context
+	void async_request(const request_factory_t& request_factory, const response_callback_t& handler);
+	std::future<std::optional<std::vector<std::uint8_t>>> request(const request_factory_t& request_factory);
+
+	// the response is passed to sink a frame at a time as it arrives, one that was not streamed arrives as a single chunk,
+	// and handler runs once all of it has, with is_valid 0 if the request failed or sink abandoned it
+	void async_request(const request_factory_t& request_factory, const frame::chunk_sink_t& sink, const async_callback_t& handler);
+
+	// sends the body pulled from source as a run of chunk frames, the next chunk is pulled once the write carrying
+	// the last one completes, so a body of any length holds one chunk in memory, the response is handled as above
+	void async_stream_request(request::request_id_t request_id, frame::chunk_source_t source, const frame::chunk_sink_t& sink, const async_callback_t& handler);
+
+	// offers the codecs in preference order, once the server agrees on one the requests sent from then on are compressed
+	// with its options, responses are decompressed whether or not compression was negotiated
+	void negotiate_compression(const std::vector<compression::options_t>& offered, const negotiation_callback_t& handler);
+
+	[[nodiscard]] std::uint64_t pending_count() const;
+
+	// every request accepted since the session started, so an unchanged count means the session sat idle
+	[[nodiscard]] std::uint64_t request_count() const;
+
+	// turns 0 for good once the socket has failed or the session was closed
+	[[nodiscard]] std::uint8_t is_open() const;
+
+protected:
+	struct pending_request_t
+	{
+		response_callback_t handler;
+
+		// takes each partial chunk of a streamed response, the last chunk goes to handler,
+		// empty for requests which cannot take a streamed response
+		frame::chunk_sink_t sink;
+	};
+
+	// a streamed request body which has not been sent in full
+	struct upload_t
+	{
+		request::request_id_t request_id;
+		request::correlation_id_t correlation_id;
+		frame::chunk_source_t source;
+	};
+
+	static pending_request_t make_streamed_request(const frame::chunk_sink_t& sink, const async_callback_t& handler);
+
+	void queue_request(const request_factory_t& request_factory, pending_request_t pending);
+
+	void read_responses();
+	[[nodiscard]] std::uint8_t handle_received_responses();
+	void pass_response_chunk(request::correlation_id_t correlation_id, std::span<std::uint8_t> chunk);
+
+	void write_queued_frames();
+	void pull_upload_chunks();
+
+	void shut_down();
+
+	std::shared_ptr<asio_context_t> io_context_;
+	std::unique_ptr<socket_t> socket_;
+
+	frame::receive_buffer_t receive_buffer_;
+
+	// only touched on the io_context, holds the body of a compressed response while its handler runs
+	std::vector<std::uint8_t> decompressed_body_;
+
+	// only touched on the io_context, by the chain of writes
+	std::vector<serialisation::frame_t> writing_frames_;
+	std::vector<socket_buffer_t> write_buffers_;
+	std::list<upload_t> uploads_;
+	std::vector<std::uint8_t> upload_buffer_;
+
+	mutable std::mutex mutex_;
+	request::correlation_table_t<pending_request_t> pending_requests_;
+	std::vector<serialisation::frame_t> queued_frames_;
+	std::list<upload_t> queued_uploads_;
+	compression::options_t compression_options_ = compression::disabled;
+	frame::wire_version_t wire_version_ = frame::wire_version_t::v1;
+	std::uint64_t request_count_ = 0;
+	std::uint8_t is_writing_ = 0;
+	std::uint8_t is_open_ = 1;
+};
@@ -0,0 +1,325 @@
+#include "session_pool.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+void client_session_pool_t::start(const async_callback_t& handler)
+{
+	{
+		const std::lock_guard lock(mutex_);
+
+		slots_.assign(options_.session_count, { .session = nullptr, .checked_request_count = 0, .is_connecting = 1 });
+	}
+
+	boost::asio::co_spawn(strand_, co_start(),
+		[self = shared_from_this(), handler](const std::exception_ptr&, const std::uint8_t is_valid)
+		{
+			handler(is_valid);
+
+			boost::asio::co_spawn(self->strand_, self->co_check_health(), [self](const std::exception_ptr&) { });
+		}
+	);
+}
+
+void client_session_pool_t::close()
+{
+	std::vector<slot_t> slots;
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		is_open_ = 0;
+
+		slots.swap(slots_);
+	}
+
+	for (const slot_t& slot : slots)
+	{
+		if (slot.session)
+		{
+			slot.session->close();
+		}
+	}
+
+	boost::asio::post(strand_,
+		[self = shared_from_this()]()
+		{
+			self->health_check_timer_.cancel();
+		}
+	);
+}
+
+void client_session_pool_t::set_health_check(health_check_t health_check)
+{
+	health_check_ = std::move(health_check);
+}
+
+std::shared_ptr<client_session_t> client_session_pool_t::acquire() const
+{
+	const std::lock_guard lock(mutex_);
+
+	std::shared_ptr<client_session_t> least_loaded;
+	std::uint64_t least_pending_count = 0;
+
+	for (const slot_t& slot : slots_)
+	{
+		if (!slot.session || !slot.session->is_open())
+		{
+			continue;
+		}
+
+		const std::uint64_t pending_count = slot.session->pending_count();
+
+		if (!least_loaded || pending_count < least_pending_count)
+		{
+			least_loaded = slot.session;
+			least_pending_count = pending_count;
+		}
+	}
+
+	return least_loaded;
+}
+
+std::uint64_t client_session_pool_t::open_count() const
+{
+	const std::lock_guard lock(mutex_);
+
+	return std::ranges::count_if(slots_,
+		[](const slot_t& slot)
+		{
+			return slot.session && slot.session->is_open();
+		}
+	);
+}
+
+awaitable_t<std::uint8_t> client_session_pool_t::co_start()
+{
+	if (!co_await co_refresh_endpoints())
+	{
+		const std::lock_guard lock(mutex_);
+
+		for (slot_t& slot : slots_)
+		{
+			slot.is_connecting = 0;
+		}
+
+		co_return 0;
+	}
+
+	// the sessions open concurrently, the timer is only cancelled once the last of them has finished
+	boost::asio::steady_timer all_finished(strand_, std::chrono::steady_clock::time_point::max());
+
+	std::uint64_t remaining_count = options_.session_count;
+	std::uint64_t opened_count = 0;
+
+	for (std::uint64_t i = 0; i < options_.session_count; i++)
+	{
+		boost::asio::co_spawn(strand_, co_open_session(i, *endpoints_),
+			[&all_finished, &remaining_count, &opened_count](const std::exception_ptr&, const std::uint8_t is_opened)
+			{
+				opened_count += is_opened;
+
+				if (--remaining_count == 0)
+				{
+					all_finished.cancel();
+				}
+			}
+		);
+	}
+
+	boost::system::error_code error_code = { };
+
+	co_await all_finished.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	spdlog::info("session pool opened {} of {} sessions", opened_count, options_.session_count);
+
+	co_return opened_count != 0;
+}
+
+awaitable_t<std::uint8_t> client_session_pool_t::co_refresh_endpoints()
+{
+	if (endpoints_.has_value() && std::chrono::steady_clock::now() - resolved_at_ < options_.resolution_lifetime)
+	{
+		co_return 1;
+	}
+
+	resolver_t resolver(strand_);
+
+	boost::system::error_code error_code = { };
+
+	resolver_t::results_type endpoints = co_await resolver.async_resolve(host_, service_, boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+	if (error_code)
+	{
+		spdlog::error("failed to resolve {}:{} ({})", host_, service_, error_code.message());
+
+		co_return 0;
+	}
+
+	endpoints_ = std::move(endpoints);
+	resolved_at_ = std::chrono::steady_clock::now();
+
+	co_return 1;
+}
+
+awaitable_t<std::uint8_t> client_session_pool_t::co_open_session(const std::uint64_t slot_index, const resolver_t::results_type endpoints)
+{
+	auto socket = std::make_unique<boost_tcp_socket_t>(io_context_, ssl_context_);
+
+	std::uint8_t is_opened = co_await socket->co_connect(endpoints);
+
+	if (!is_opened)
+	{
+		// the host may have moved, so the next attempt resolves it again
+		endpoints_.reset();
+	}
+	else
+	{
+		socket->set_keep_alive(1);
+
+		is_opened = co_await socket->co_handshake(socket_t::handshake_type_t::client);
+	}
+
+	std::shared_ptr<client_session_t> session;
+
+	if (is_opened)
+	{
+		session = std::make_shared<client_session_t>(io_context_, std::move(socket));
+
+		session->set_wire_version(options_.wire_version);
+		session->start();
+	}
+
+	{
+		const std::lock_guard lock(mutex_);
+
+		if (is_open_ && slot_index < slots_.size())
+		{
+			slots_[slot_index] = { .session = session, .checked_request_count = 0, .is_connecting = 0 };
+
+			co_return is_opened;
+		}
+	}
+
+	// the pool closed while this session was opening
+	if (session)
+	{
+		session->close();
+	}
+
+	co_return 0;
+}
+
+// replaces failed sessions and probes the ones which have not been used since the previous check
+awaitable_t<void> client_session_pool_t::co_check_health()
+{
+	while (true)
+	{
+		boost::system::error_code error_code = { };
+
+		health_check_timer_.expires_after(options_.health_check_interval);
+
+		co_await health_check_timer_.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error_code));
+
+		std::vector<std::uint64_t> failed_slots;
+		std::vector<std::pair<std::uint64_t, std::shared_ptr<client_session_t>>> idle_sessions;
+
+		{
+			const std::lock_guard lock(mutex_);
+
+			if (!is_open_)
+			{
+				co_return;
+			}
+
+			for (std::uint64_t i = 0; i < slots_.size(); i++)
+			{
+				slot_t& slot = slots_[i];
+
+				if (slot.is_connecting)
+				{
+					continue;
+				}
+
+				if (!slot.session || !slot.session->is_open())
+				{
+					slot.session = nullptr;
+					slot.is_connecting = 1;
+
+					failed_slots.push_back(i);
+
+					continue;
+				}
+
+				const std::uint64_t request_count = slot.session->request_count();
+
+				if (request_count == slot.checked_request_count && slot.session->pending_count() == 0)
+				{
+					idle_sessions.emplace_back(i, slot.session);
+				}
+
+				slot.checked_request_count = request_count;
+			}
+		}
+
+		if (!failed_slots.empty())
+		{
+			if (co_await co_refresh_endpoints())
+			{
+				spdlog::info("session pool is replacing {} sessions", failed_slots.size());
+
+				for (const std::uint64_t slot_index : failed_slots)
+				{
+					boost::asio::co_spawn(strand_, co_open_session(slot_index, *endpoints_), [self = shared_from_this()](const std::exception_ptr&, std::uint8_t) { });
+				}
+			}
+			else
+			{
+				const std::lock_guard lock(mutex_);
+
+				for (const std::uint64_t slot_index : failed_slots)
+				{
+					if (slot_index < slots_.size())
+					{
+						slots_[slot_index].is_connecting = 0;
+					}
+				}
+			}
+		}
+
+		if (health_check_)
+		{
+			for (const auto& [slot_index, session] : idle_sessions)
+			{
+				check_session(slot_index, session);
+			}
+		}
+	}
+}
+
+void client_session_pool_t::check_session(const std::uint64_t slot_index, const std::shared_ptr<client_session_t>& session)
+{
+	health_check_(*session,
+		[self = shared_from_this(), slot_index, session](const std::uint8_t is_valid)
+		{
+			if (!is_valid)
+			{
+				spdlog::error("session failed its health check");
+
+				// the next check replaces it
+				session->close();
+
+				return;
+			}
+
+			const std::lock_guard lock(self->mutex_);
+
+			// the probe itself is not activity, otherwise an idle session would only be probed every other check
+			if (slot_index < self->slots_.size() && self->slots_[slot_index].session == session)
+			{
+				self->slots_[slot_index].checked_request_count = session->request_count();
+			}
+		}
+	);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "session.hpp"
+
+#include <chrono>
+
+// keeps a number of sessions to one server open and hands out the least loaded of them,
+// must be created as a shared ptr and its io_context must be run by at least one thread
+class client_session_pool_t final : public std::enable_shared_from_this<client_session_pool_t>
+{
+public:
+	typedef boost::asio::io_context asio_context_t;
+	typedef boost_tcp_socket_t::resolver_t resolver_t;
+
+	// probes an idle session, such as with a cheap request, and reports whether it answered
+	typedef std::function<void(client_session_t& session, const async_callback_t& handler)> health_check_t;
+
+	struct options_t
+	{
+		std::uint32_t session_count;
+
+		// how often failed sessions are replaced and idle sessions are probed
+		std::chrono::milliseconds health_check_interval;
+
+		// the resolved endpoints are reused for this long, or until no endpoint accepts a connection
+		std::chrono::seconds resolution_lifetime;
+
+		// see client_session_t::set_wire_version
+		frame::wire_version_t wire_version;
+	};
+
+	static constexpr options_t default_options = { .session_count = 4, .health_check_interval = std::chrono::seconds(10), .resolution_lifetime = std::chrono::minutes(5),
+		.wire_version = frame::wire_version_t::v1 };
+
+	explicit client_session_pool_t(std::shared_ptr<asio_context_t> io_context, std::shared_ptr<boost_ssl_context_t> ssl_context, std::string host, std::string service, const options_t& options = default_options)
+			:	io_context_(std::move(io_context)),
+				ssl_context_(std::move(ssl_context)),
+				host_(std::move(host)),
+				service_(std::move(service)),
+				options_(options),
+				strand_(boost::asio::make_strand(*io_context_)),
+				health_check_timer_(strand_) { }
+
+	// resolves the host once and connects and handshakes every session in parallel, the handler runs when all of them
+	// have opened or failed and is valid if any opened, from then on failed sessions are replaced in the background
+	void start(const async_callback_t& handler);
+	void close();
+
+	// set before start
+	void set_health_check(health_check_t health_check);
+
+	// may be called from any thread, null while no session is open
+	[[nodiscard]] std::shared_ptr<client_session_t> acquire() const;
+
+	[[nodiscard]] std::uint64_t open_count() const;
+
+protected:
+	struct slot_t
+	{
+		std::shared_ptr<client_session_t> session;
+		std::uint64_t checked_request_count;
+		std::uint8_t is_connecting;
+	};
+
+	// every coroutine runs on the strand, which also guards the endpoints and the timer
+	awaitable_t<std::uint8_t> co_start();
+	awaitable_t<std::uint8_t> co_refresh_endpoints();
+	awaitable_t<std::uint8_t> co_open_session(std::uint64_t slot_index, resolver_t::results_type endpoints);
+	awaitable_t<void> co_check_health();
+
+	void check_session(std::uint64_t slot_index, const std::shared_ptr<client_session_t>& session);
+
+	std::shared_ptr<asio_context_t> io_context_;
+	std::shared_ptr<boost_ssl_context_t> ssl_context_;
+	std::string host_;
+	std::string service_;
+	options_t options_;
+	health_check_t health_check_;
+
+	boost::asio::strand<asio_context_t::executor_type> strand_;
+	boost::asio::steady_timer health_check_timer_;
+	std::optional<resolver_t::results_type> endpoints_;
+	std::chrono::steady_clock::time_point resolved_at_;
+
+	mutable std::mutex mutex_;
+	std::vector<slot_t> slots_;
+	std::uint8_t is_open_ = 1;
+};